@@ -25,6 +25,7 @@
 
 #include <vector>
 #include <memory>
+#include <algorithm>
 #include <PiHWCtrl/HWInterfaces/Observer.h>
 
 namespace PiHWCtrl {
@@ -39,37 +40,166 @@ namespace PiHWCtrl {
  * every time they want to generate an event of type T. The Observable has the
  * logic of keeping and notifying the observers already implemented.
  * 
+ * The class is thread safe. The list of the observers is immutable and it is
+ * replaced by a modified copy when observers are added or removed (copy on
+ * write), so the notifyObservers() never blocks. An observer removed while an
+ * event is being generated might still receive that event.
+ * 
  * @tparam T
  *    The type of the event
  */
 template <typename T>
 class Observable {
   
+  // The state is kept in a shared pointer, so subscriptions can detect if the
+  // observable does not exist any more
+  struct State;
+  
 public:
   
+  class Subscription;
+  
+  Observable() = default;
+  
+  /// Copying an observable copies its current observers
+  Observable(const Observable& other) {
+    m_state->observers = std::atomic_load(&other.m_state->observers);
+  }
+  
+  Observable& operator=(const Observable& other) {
+    std::atomic_store(&m_state->observers, std::atomic_load(&other.m_state->observers));
+    return *this;
+  }
+  
   virtual ~Observable() = default;
   
   /// Adds an observer, which will be notified for future events
   void addObserver(std::shared_ptr<Observer<T>> observer) {
-    m_observers.push_back(observer);
+    update(*m_state, [&observer](ObserverList& list) {
+      list.push_back(observer);
+    });
+  }
+  
+  /// Removes an observer (once, if it was added multiple times), so it will
+  /// not be notified for future events
+  void removeObserver(const std::shared_ptr<Observer<T>>& observer) {
+    remove(*m_state, observer);
+  }
+  
+  /// Adds an observer, which will be removed when the returned Subscription is
+  /// destroyed
+  Subscription subscribe(std::shared_ptr<Observer<T>> observer) {
+    addObserver(observer);
+    return Subscription {m_state, observer};
+  }
+  
+  /// Returns true if there is at least one observer
+  bool hasObservers() const {
+    return !std::atomic_load(&m_state->observers)->empty();
   }
   
 protected:
   
   /// Method to be called by the implementations to generate events of type T
   void notifyObservers(const T& value) {
-    for (auto& obs : m_observers) {
+    // We keep a reference to the current list, so it stays alive even if it is
+    // replaced while we notify
+    auto observers = std::atomic_load(&m_state->observers);
+    for (auto& obs : *observers) {
       obs->event(value);
     }
   }
   
 private:
   
-  std::vector<std::shared_ptr<Observer<T>>> m_observers;
+  using ObserverList = std::vector<std::shared_ptr<Observer<T>>>;
+  
+  struct State {
+    std::shared_ptr<const ObserverList> observers = std::make_shared<const ObserverList>();
+  };
+  
+  template <typename Func>
+  static void update(State& state, Func func) {
+    auto current = std::atomic_load(&state.observers);
+    std::shared_ptr<const ObserverList> updated;
+    do {
+      auto copy = std::make_shared<ObserverList>(*current);
+      func(*copy);
+      updated = std::move(copy);
+    } while (!std::atomic_compare_exchange_weak(&state.observers, &current, updated));
+  }
+  
+  static void remove(State& state, const std::shared_ptr<Observer<T>>& observer) {
+    update(state, [&observer](ObserverList& list) {
+      auto it = std::find(list.begin(), list.end(), observer);
+      if (it != list.end()) {
+        list.erase(it);
+      }
+    });
+  }
+  
+  std::shared_ptr<State> m_state = std::make_shared<State>();
+  
+};
+
+/**
+ * @class Observable::Subscription
+ * 
+ * @brief Handle which removes an observer from an Observable when destroyed
+ * 
+ * @details
+ * The subscription can be moved but not copied. It can safely outlive the
+ * Observable it was created from.
+ */
+template <typename T>
+class Observable<T>::Subscription {
+  
+public:
+  
+  /// Creates an empty subscription
+  Subscription() = default;
+  
+  Subscription(const Subscription&) = delete;
+  Subscription& operator=(const Subscription&) = delete;
+  
+  Subscription(Subscription&& other) = default;
+  
+  Subscription& operator=(Subscription&& other) {
+    if (this != &other) {
+      reset();
+      m_state = std::move(other.m_state);
+      m_observer = std::move(other.m_observer);
+    }
+    return *this;
+  }
+  
+  /// Removes the observer
+  ~Subscription() {
+    reset();
+  }
+  
+  /// Removes the observer now, instead of when the subscription is destroyed
+  void reset() {
+    if (auto state = m_state.lock()) {
+      Observable<T>::remove(*state, m_observer);
+    }
+    m_state.reset();
+    m_observer.reset();
+  }
+  
+private:
+  
+  friend class Observable<T>;
+  
+  Subscription(std::weak_ptr<State> state, std::shared_ptr<Observer<T>> observer)
+          : m_state(state), m_observer(observer) {
+  }
+  
+  std::weak_ptr<State> m_state;
+  std::shared_ptr<Observer<T>> m_observer;
   
 };
 
 }
 
 #endif /* PIHWCTRL_HWINTERFACES_OBSERVABLE_H */
-
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file PiHWCtrl/HWInterfaces/ParallelInput.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_PARALLELINPUT_H
+#define PIHWCTRL_PARALLELINPUT_H
+
+#include <cstdint>
+
+namespace PiHWCtrl {
+
+/**
+ * @class ParallelInput
+ * 
+ * @brief
+ * Interface representing a set of binary inputs which are read together
+ * 
+ * @details
+ * A parallel input is a group of up to 32 lines, whose states are all read at
+ * the same time as a single word. The bit i of the word is the state of the
+ * i-th line.
+ */
+class ParallelInput {
+  
+public:
+  
+  /// Default destructor
+  virtual ~ParallelInput() = default;
+  
+  /// Must be implemented by the subclasses to return the states of all the
+  /// lines as the bits of a word, with 1 meaning ON and 0 meaning OFF.
+  virtual std::uint32_t read() const = 0;
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_PARALLELINPUT_H */
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file PiHWCtrl/HWInterfaces/ParallelOutput.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_PARALLELOUTPUT_H
+#define PIHWCTRL_PARALLELOUTPUT_H
+
+#include <cstdint>
+
+namespace PiHWCtrl {
+
+/**
+ * @class ParallelOutput
+ * 
+ * @brief
+ * Interface representing a set of binary outputs which are set together
+ * 
+ * @details
+ * A parallel output is a group of up to 32 lines (like a parallel data bus or
+ * the segments of a display), which are all set by a single word. The bit i of
+ * the word controls the state of the i-th line.
+ */
+class ParallelOutput {
+  
+public:
+  
+  /// Default destructor
+  virtual ~ParallelOutput() = default;
+  
+  /// Must be implemented by the subclasses to set the states of all the lines
+  /// to the bits of the given word, with 1 meaning ON and 0 meaning OFF.
+  virtual void write(std::uint32_t word) = 0;
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_PARALLELOUTPUT_H */
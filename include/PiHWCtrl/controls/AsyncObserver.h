@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file PiHWCtrl/controls/AsyncObserver.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_CONTROLS_ASYNCOBSERVER_H
+#define PIHWCTRL_CONTROLS_ASYNCOBSERVER_H
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <PiHWCtrl/HWInterfaces/Observer.h>
+#include <PiHWCtrl/utils/RingBuffer.h>
+
+namespace PiHWCtrl {
+
+/// What an AsyncObserver does with a new event when its queue is full
+enum class OverflowPolicy {
+  DROP_OLDEST, ///< Drop the oldest queued event to make space for the new one
+  DROP_NEWEST, ///< Drop the new event
+  BLOCK        ///< Block the generating thread until there is space
+};
+
+/**
+ * @class AsyncObserver
+ * 
+ * @brief Decorator which delivers the events to another observer asynchronously
+ * 
+ * @details
+ * The events are put in a bounded lock-free queue and they are forwarded to the
+ * wrapped observer by a thread owned by the AsyncObserver. This way a slow
+ * observer does not delay the thread generating the events (for example the
+ * measuring thread of a module). The order of the events is preserved.
+ * 
+ * The generating thread only touches the lock-free queue. The mutex and the
+ * condition variables are used only when the delivery thread has nothing to
+ * do, or with the BLOCK policy when the queue is full.
+ * 
+ * @tparam T
+ *    The type of the event. It must be default constructible and copyable.
+ */
+template <typename T>
+class AsyncObserver : public Observer<T> {
+  
+public:
+  
+  /**
+   * @brief Creates a new AsyncObserver
+   * 
+   * @param observer
+   *    The observer to deliver the events to
+   * @param capacity
+   *    The maximum number of queued events (rounded up to a power of two)
+   * @param policy
+   *    What to do when an event arrives and the queue is full
+   */
+  AsyncObserver(std::shared_ptr<Observer<T>> observer, std::size_t capacity=64,
+                OverflowPolicy policy=OverflowPolicy::DROP_OLDEST)
+          : m_observer(observer), m_queue(capacity), m_policy(policy) {
+    m_thread = std::thread {[this]() { deliveryLoop(); }};
+  }
+  
+  AsyncObserver(const AsyncObserver&) = delete;
+  AsyncObserver& operator=(const AsyncObserver&) = delete;
+  
+  /// Delivers the events still in the queue and stops the delivery thread
+  virtual ~AsyncObserver() {
+    {
+      std::lock_guard<std::mutex> lock {m_mutex};
+      m_stopping = true;
+    }
+    m_not_empty.notify_all();
+    m_not_full.notify_all();
+    m_thread.join();
+  }
+  
+  /// Queues the event for delivery, following the overflow policy when the
+  /// queue is full
+  void event(const T& value) override {
+    if (m_queue.tryPush(value)) {
+      wakeDeliveryThread();
+      return;
+    }
+    
+    switch (m_policy) {
+      case OverflowPolicy::DROP_NEWEST:
+        ++m_dropped;
+        break;
+      case OverflowPolicy::DROP_OLDEST: {
+        T oldest;
+        do {
+          if (m_queue.tryPop(oldest)) {
+            ++m_dropped;
+          }
+        } while (!m_queue.tryPush(value));
+        wakeDeliveryThread();
+        break;
+      }
+      case OverflowPolicy::BLOCK: {
+        std::unique_lock<std::mutex> lock {m_mutex};
+        ++m_blocked_producers;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!m_queue.tryPush(value) && !m_stopping) {
+          m_not_full.wait(lock);
+        }
+        --m_blocked_producers;
+        lock.unlock();
+        wakeDeliveryThread();
+        break;
+      }
+    }
+  }
+  
+  /// Returns the number of events which were dropped because the queue was full
+  std::uint64_t getDroppedCount() const {
+    return m_dropped;
+  }
+  
+  /// Returns the number of events delivered to the wrapped observer
+  std::uint64_t getDeliveredCount() const {
+    return m_delivered;
+  }
+  
+  /// Returns the number of events waiting in the queue
+  std::size_t getQueuedCount() const {
+    return m_queue.size();
+  }
+  
+private:
+  
+  void wakeDeliveryThread() {
+    // Pairs with the fence of the delivery thread, so either it sees the new
+    // event before sleeping or we see that it is sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleeping) {
+      std::lock_guard<std::mutex> lock {m_mutex};
+      m_not_empty.notify_one();
+    }
+  }
+  
+  void deliveryLoop() {
+    T value;
+    while (true) {
+      if (m_queue.tryPop(value)) {
+        // Pairs with the fence of the blocked producers, so either they see
+        // the free space or we see that they are waiting
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_blocked_producers > 0) {
+          std::lock_guard<std::mutex> lock {m_mutex};
+          m_not_full.notify_all();
+        }
+        m_observer->event(value);
+        ++m_delivered;
+        continue;
+      }
+      
+      // The queue is empty, so we sleep until an event arrives
+      std::unique_lock<std::mutex> lock {m_mutex};
+      m_sleeping = true;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      while (m_queue.size() == 0 && !m_stopping) {
+        m_not_empty.wait(lock);
+      }
+      m_sleeping = false;
+      if (m_stopping && m_queue.size() == 0) {
+        return;
+      }
+    }
+  }
+  
+  std::shared_ptr<Observer<T>> m_observer;
+  RingBuffer<T> m_queue;
+  OverflowPolicy m_policy;
+  std::mutex m_mutex;
+  std::condition_variable m_not_empty;
+  std::condition_variable m_not_full;
+  std::atomic<bool> m_sleeping {false};
+  std::atomic<int> m_blocked_producers {0};
+  bool m_stopping {false};
+  std::atomic<std::uint64_t> m_dropped {0};
+  std::atomic<std::uint64_t> m_delivered {0};
+  std::thread m_thread;
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_CONTROLS_ASYNCOBSERVER_H */
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file PiHWCtrl/controls/RingRecorder.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_CONTROLS_RINGRECORDER_H
+#define PIHWCTRL_CONTROLS_RINGRECORDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib> // for posix_memalign, std::free
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <new>
+#include <PiHWCtrl/HWInterfaces/Observer.h>
+#include <PiHWCtrl/HWInterfaces/exceptions.h>
+
+namespace PiHWCtrl {
+
+/**
+ * @class RingRecorder
+ * 
+ * @brief Observer which records the events with their timestamps in a ring
+ * buffer
+ * 
+ * @details
+ * The records are kept in a buffer which is allocated (aligned to the cache
+ * lines) when the recorder is created, so recording an event does not
+ * allocate any memory. One thread can record the events (the thread generating
+ * them) and one other thread can read them in bulk with the drain() method,
+ * without any locking. When the buffer is full new events are dropped and
+ * counted, so the generating thread is never delayed.
+ * 
+ * @tparam T
+ *    The type of the event. It must be default constructible and copyable.
+ */
+template <typename T>
+class RingRecorder : public Observer<T> {
+  
+public:
+  
+  using Clock = std::chrono::steady_clock;
+  
+  /// A recorded event
+  struct Record {
+    Clock::time_point timestamp;
+    T value;
+  };
+  
+  /// Creates a recorder which can keep the given number of records (rounded up
+  /// to the next power of two)
+  RingRecorder(std::size_t capacity) {
+    if (capacity == 0) {
+      throw Exception() << "RingRecorder capacity must be positive";
+    }
+    m_capacity = 1;
+    while (m_capacity < capacity) {
+      m_capacity <<= 1;
+    }
+    m_mask = m_capacity - 1;
+    void* memory = nullptr;
+    if (posix_memalign(&memory, CACHE_LINE, m_capacity * sizeof(Record)) != 0) {
+      throw std::bad_alloc();
+    }
+    m_records.reset(static_cast<Record*>(memory));
+    for (std::size_t i = 0; i < m_capacity; ++i) {
+      new (&m_records.get()[i]) Record{};
+    }
+  }
+  
+  RingRecorder(const RingRecorder&) = delete;
+  RingRecorder& operator=(const RingRecorder&) = delete;
+  
+  virtual ~RingRecorder() {
+    for (std::size_t i = 0; i < m_capacity; ++i) {
+      m_records.get()[i].~Record();
+    }
+  }
+  
+  /// Records the event with the current time. To be called by the producer
+  /// thread only.
+  void event(const T& value) override {
+    std::size_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_cached_tail == m_capacity) {
+      // The buffer looked full, so we check again where the consumer is
+      m_cached_tail = m_tail.load(std::memory_order_acquire);
+      if (head - m_cached_tail == m_capacity) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+    }
+    Record& record = m_records.get()[head & m_mask];
+    record.timestamp = Clock::now();
+    record.value = value;
+    m_head.store(head + 1, std::memory_order_release);
+  }
+  
+  /**
+   * @brief Moves the oldest records to the given array
+   * 
+   * @details
+   * To be called by the consumer thread only.
+   * 
+   * @param out
+   *    The array to copy the records to
+   * @param max
+   *    The size of the array
+   * @return
+   *    The number of the records copied
+   */
+  std::size_t drain(Record* out, std::size_t max) {
+    std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (m_cached_head - tail < max) {
+      m_cached_head = m_head.load(std::memory_order_acquire);
+    }
+    std::size_t count = m_cached_head - tail;
+    if (count > max) {
+      count = max;
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+      out[i] = m_records.get()[(tail + i) & m_mask];
+    }
+    m_tail.store(tail + count, std::memory_order_release);
+    return count;
+  }
+  
+  /// Returns the number of events dropped because the buffer was full
+  std::uint64_t getDroppedCount() const {
+    return m_dropped.load(std::memory_order_relaxed);
+  }
+  
+  /// Returns the maximum number of records the buffer can keep
+  std::size_t capacity() const {
+    return m_capacity;
+  }
+  
+private:
+  
+  static constexpr std::size_t CACHE_LINE = 64;
+  
+  struct FreeDeleter {
+    void operator()(Record* records) const {
+      std::free(records);
+    }
+  };
+  
+  std::size_t m_capacity;
+  std::size_t m_mask;
+  std::unique_ptr<Record, FreeDeleter> m_records;
+  // Each side has its own cache line with its index and a copy of the index of
+  // the other side, so they read each other's index only when they need to
+  alignas(CACHE_LINE) std::atomic<std::size_t> m_head {0};
+  std::size_t m_cached_tail {0};
+  std::atomic<std::uint64_t> m_dropped {0};
+  alignas(CACHE_LINE) std::atomic<std::size_t> m_tail {0};
+  std::size_t m_cached_head {0};
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_CONTROLS_RINGRECORDER_H */
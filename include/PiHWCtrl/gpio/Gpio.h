@@ -25,6 +25,7 @@
 
 #include <string>
 #include <PiHWCtrl/utils/GpioManager.h>
+#include <PiHWCtrl/gpio/GpioValueFile.h>
 
 namespace PiHWCtrl {
 
@@ -42,7 +43,9 @@ namespace PiHWCtrl {
  * - true : ON - 3V3 connected to the pin
  * - false : OFF - GND connected to the pin
  * 
- * This class can be used to control a GPIO both as input and as output.
+ * This class can be used to control a GPIO both as input and as output. The
+ * value file of the GPIO is kept open for the lifetime of the object, so
+ * reading and setting the state costs a single system call.
  */
 class Gpio {
   
@@ -51,6 +54,11 @@ public:
   enum class Mode {
     INPUT, OUTPUT
   };
+  
+  /// The signal edges which generate interrupts for input GPIOs
+  enum class Edge {
+    NONE, RISING, FALLING, BOTH
+  };
 
   /**
    * @brief Constructs a new Gpio object
@@ -75,11 +83,38 @@ public:
   virtual ~Gpio() = default;
   
   /// Returns the state of the GPIO
+  /// @throws GpioException If reading the value file fails
   bool getState() const;
   
   /// Sets the state of the GPIO (only for output GPIOs)
+  /// @throws GpioException If writing the value file fails
   void setState(bool state);
   
+  /// Sets the signal edges for which waitForEdge() returns (only for input GPIOs)
+  /// @throws GpioException If the driver does not support interrupts for the GPIO
+  void setEdge(Edge edge);
+  
+  /**
+   * @brief Blocks until the GPIO detects one of the edges set with setEdge()
+   * 
+   * @details
+   * The method uses poll() on the value file, so the calling thread consumes
+   * no CPU while waiting. After it returns true, getState() must be called
+   * before waiting again, to acknowledge the edge to the driver.
+   * 
+   * If the interrupt_fd parameter is a valid file descriptor (for example an
+   * eventfd), the method returns false as soon as it becomes readable, after
+   * draining it. This can be used by other threads to cancel the wait.
+   * 
+   * @param interrupt_fd
+   *    A file descriptor which can interrupt the wait, or -1 for none
+   * @return
+   *    true if an edge was detected, false if the wait was interrupted
+   * @throws GpioException
+   *    If polling the value file fails
+   */
+  bool waitForEdge(int interrupt_fd=-1) const;
+  
 private:
   
   struct GpioExporter {
@@ -90,7 +125,8 @@ private:
   
   std::unique_ptr<GpioManager::GpioReservation> m_gpio_reservation;
   std::unique_ptr<GpioExporter> m_gpio_exporter;
-  std::string m_value_file;
+  std::string m_gpio_dir;
+  std::unique_ptr<GpioValueFile> m_value_file;
   
 };
 
@@ -24,10 +24,12 @@
 #define PIHWCTRL_GPIO_GPIOBINARYINPUT_H
 
 #include <mutex>
-#include <atomic>
+#include <memory>
 #include <PiHWCtrl/HWInterfaces/BinaryInput.h>
 #include <PiHWCtrl/HWInterfaces/Observable.h>
 #include <PiHWCtrl/gpio/Gpio.h>
+#include <PiHWCtrl/utils/SamplingWorker.h>
+#include <PiHWCtrl/utils/SamplingScheduler.h>
 
 namespace PiHWCtrl {
 
@@ -71,17 +73,39 @@ public:
   bool isOn() const override;
   
   /// Start monitoring the pin and notify the observers for its state every sleep_ms
-  /// milliseconds
+  /// milliseconds. The polling is done by the shared SamplingScheduler, so it
+  /// does not need a thread of its own.
   void start(unsigned int sleep_ms=10);
   
-  /// Stop monitoring the pin
+  /**
+   * @brief Start monitoring the pin using interrupts
+   * 
+   * @details
+   * Instead of polling the pin periodically, the driver is configured to
+   * detect the given signal edges and the observers are notified with the new
+   * state only when such an edge occurs. The monitoring thread sleeps while
+   * nothing happens at the pin.
+   * 
+   * @param edge
+   *    The signal edges to notify the observers for
+   * @throws GpioException
+   *    If the monitoring is already started or if the driver does not support
+   *    interrupts for the GPIO
+   */
+  void startOnEdge(Gpio::Edge edge=Gpio::Edge::BOTH);
+  
+  /// Stop monitoring the pin. It returns when the monitoring thread has
+  /// finished.
   void stop();
 
 private:
   
   Gpio m_gpio;
   mutable std::mutex m_gpio_mutex;
-  std::atomic<bool> m_observing {false};
+  int m_wakeup_fd;
+  SamplingWorker m_worker;
+  std::shared_ptr<SamplingScheduler> m_scheduler = SamplingScheduler::getSingleton();
+  SamplingScheduler::JobId m_poll_job {0};
   
 };
 
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file PiHWCtrl/gpio/GpioValueFile.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_GPIO_GPIOVALUEFILE_H
+#define PIHWCTRL_GPIO_GPIOVALUEFILE_H
+
+#include <string>
+
+namespace PiHWCtrl {
+
+/**
+ * @class GpioValueFile
+ * 
+ * @brief Access to the sysfs value file of a GPIO
+ * 
+ * @details
+ * The file is kept open for the lifetime of the object, so reading and
+ * setting the value costs a single pread() / pwrite() at offset 0. This class
+ * is used by the Gpio class, which also exports the GPIO and sets its
+ * direction. It does not depend on anything else of the sysfs tree, so it can
+ * be used with any file containing the character '0' or '1'.
+ */
+class GpioValueFile {
+  
+public:
+  
+  /**
+   * @brief Opens the given value file
+   * 
+   * @param filename
+   *    The path of the value file
+   * @param writable
+   *    If the file is opened for writing (for output GPIOs) or only for reading
+   * @throws GpioException
+   *    If the file cannot be opened
+   */
+  GpioValueFile(const std::string& filename, bool writable);
+  
+  // The object owns the file descriptor, so it cannot be copied
+  GpioValueFile(const GpioValueFile&) = delete;
+  GpioValueFile& operator=(const GpioValueFile&) = delete;
+  
+  /// Closes the file
+  virtual ~GpioValueFile();
+  
+  /// Returns false if the first character of the file is '0', true otherwise
+  /// @throws GpioException If reading the file fails
+  bool read() const;
+  
+  /// Writes the character '1' or '0' at the beginning of the file
+  /// @throws GpioException If writing the file fails
+  void write(bool value);
+  
+  /**
+   * @brief Blocks until the driver signals an edge on the file (a POLLPRI
+   * event) or until the interrupt_fd becomes readable
+   * 
+   * @details
+   * See Gpio::waitForEdge() for the details.
+   * 
+   * @param interrupt_fd
+   *    A file descriptor which can interrupt the wait, or -1 for none
+   * @return
+   *    true if an edge was detected, false if the wait was interrupted
+   * @throws GpioException
+   *    If polling the file fails
+   */
+  bool waitForEdge(int interrupt_fd=-1) const;
+  
+  /// Returns the path of the value file
+  const std::string& getFilename() const;
+  
+private:
+  
+  std::string m_filename;
+  int m_fd;
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_GPIO_GPIOVALUEFILE_H */
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file PiHWCtrl/gpiocdev/GpioLineRequest.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_GPIOCDEV_GPIOLINEREQUEST_H
+#define PIHWCTRL_GPIOCDEV_GPIOLINEREQUEST_H
+
+#include <cstdint>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <PiHWCtrl/utils/GpioManager.h>
+
+namespace PiHWCtrl {
+
+/**
+ * @class GpioLineRequest
+ * 
+ * @brief Handle to a set of GPIO lines requested from the GPIO character device
+ * 
+ * @details
+ * This class uses the GPIO v2 ioctls of the /dev/gpiochipN character device,
+ * which replaces the deprecated sysfs interface. All the requested lines
+ * share a single file descriptor, so their values can be read or set with a
+ * single ioctl call. The values are represented as a bitmap, where the bit i
+ * corresponds to the i-th GPIO given at the constructor:
+ * 
+ * - 1 : ON - 3V3 connected to the pin
+ * - 0 : OFF - GND connected to the pin
+ * 
+ * The lines of the chip 0 of the Raspberry Pi are the BCM GPIO numbers, so the
+ * GPIOs 2-28 of the 40 pin interface can be used directly. The GPIOs are
+ * reserved via the GpioManager for the lifetime of the object.
+ */
+class GpioLineRequest {
+  
+public:
+  
+  enum class Direction {
+    INPUT, OUTPUT
+  };
+  
+  /// The signal edges for which the kernel generates events (only for inputs)
+  enum class Edge {
+    NONE, RISING, FALLING, BOTH
+  };
+  
+  /// An edge detected by the kernel
+  struct Event {
+    /// The GPIO at which the edge occurred
+    int gpio;
+    /// True for rising edges (OFF to ON), false for falling edges
+    bool rising;
+    /// The time the kernel detected the edge, in the CLOCK_MONOTONIC clock
+    std::chrono::nanoseconds timestamp;
+  };
+  
+  /**
+   * @brief Requests the given GPIOs from the kernel
+   * 
+   * @param gpios
+   *    The GPIOs to request (maximum 64)
+   * @param direction
+   *    If the GPIOs will be used as inputs or outputs
+   * @param edge
+   *    The edges for which events are generated (only for inputs)
+   * @param initial_values
+   *    The bitmap with the initial values (only for outputs)
+   * @param chip
+   *    The number N of the /dev/gpiochipN device
+   * 
+   * @throws GpioAlreadyReserved
+   *    If any of the GPIOs is already reserved by another PiHWCtrl object
+   * @throws BadGpioNumber
+   *    If any of the GPIOs is out of the range 2-28
+   * @throws GpiocdevException
+   *    If the kernel refuses the request
+   */
+  GpioLineRequest(const std::vector<int>& gpios, Direction direction,
+                  Edge edge=Edge::NONE, std::uint64_t initial_values=0, int chip=0);
+  
+  // A GpioLineRequest represents physical GPIOs, so it cannot be copied
+  GpioLineRequest(const GpioLineRequest&) = delete;
+  GpioLineRequest& operator=(const GpioLineRequest&) = delete;
+
+  /// Releases the GPIOs
+  virtual ~GpioLineRequest();
+  
+  /// Returns the requested GPIOs, in the order of the bits of the values
+  const std::vector<int>& getGpios() const;
+  
+  /// Returns the bitmap with the values of all the lines, read with a single ioctl
+  std::uint64_t getValues() const;
+  
+  /// Sets the values of the lines selected by the mask with a single ioctl. The
+  /// mask bits above the requested lines are ignored.
+  void setValues(std::uint64_t values, std::uint64_t mask=~std::uint64_t{0});
+  
+  /**
+   * @brief Blocks until the kernel reports an edge on one of the lines
+   * 
+   * @details
+   * If the interrupt_fd parameter is a valid file descriptor (for example an
+   * eventfd), the method returns false as soon as it becomes readable, after
+   * draining it. This can be used by other threads to cancel the wait.
+   * 
+   * @param event
+   *    Is set to the detected edge
+   * @param interrupt_fd
+   *    A file descriptor which can interrupt the wait, or -1 for none
+   * @return
+   *    true if an edge was detected, false if the wait was interrupted
+   */
+  bool waitForEvent(Event& event, int interrupt_fd=-1) const;
+  
+private:
+  
+  std::vector<int> m_gpios;
+  std::vector<std::unique_ptr<GpioManager::GpioReservation>> m_reservations;
+  int m_line_fd;
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_GPIOCDEV_GPIOLINEREQUEST_H */
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file PiHWCtrl/gpiocdev/GpiocdevBinaryInput.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_GPIOCDEV_GPIOCDEVBINARYINPUT_H
+#define PIHWCTRL_GPIOCDEV_GPIOCDEVBINARYINPUT_H
+
+#include <memory>
+#include <PiHWCtrl/HWInterfaces/BinaryInput.h>
+#include <PiHWCtrl/HWInterfaces/Observable.h>
+#include <PiHWCtrl/utils/EncapsulatedObservable.h>
+#include <PiHWCtrl/utils/SamplingWorker.h>
+#include <PiHWCtrl/gpiocdev/GpioLineRequest.h>
+
+namespace PiHWCtrl {
+
+/**
+ * @class GpiocdevBinaryInput
+ * 
+ * @brief
+ * Implementation of the BinaryInput interface using the GPIO character device
+ * 
+ * @details
+ * This class can be used to access the GPIOs 2-28 of the 40 pin interface of
+ * the Raspberry Pi. The input is interpreted as following:
+ * 
+ * - ON: 3.3 Volt connected to the pin
+ * - OFF: GND connected to the pin or the pin is open circuited
+ * 
+ * The edges of the signal are detected by the kernel, so the observers are
+ * notified only when the state of the pin changes. Observers which need the
+ * time the edge happened can be added with the addEdgeEventObserver(), in
+ * which case they receive the timestamp recorded by the kernel.
+ */
+class GpiocdevBinaryInput : public BinaryInput, public Observable<bool> {
+  
+public:
+  
+  /**
+   * @brief Creates a GpiocdevBinaryInput for the requested pin
+   * 
+   * @param gpio
+   *    The number of the GPIO to use as the input
+   * @param edge
+   *    The edges of the signal for which the observers are notified
+   * @param chip
+   *    The number N of the /dev/gpiochipN device
+   * 
+   * @throws GpioAlreadyResearved
+   *    If the requested GPIO is already reserved by another PiHWCtrl object
+   * @throws BadGpioNumber
+   *    If the given number is out of the range 2-28
+   * @throws GpiocdevException
+   *    If there was any problem with the communication with the driver
+   */
+  GpiocdevBinaryInput(int gpio, GpioLineRequest::Edge edge=GpioLineRequest::Edge::BOTH,
+                      int chip=0);
+
+  /// Releases the physical GPIO
+  virtual ~GpiocdevBinaryInput();
+  
+  /// Returns true if the input is ON (as described at the class documentation)
+  /// and false otherwise
+  bool isOn() const override;
+  
+  /// Adds an observer which will be notified for the edges with their timestamps
+  void addEdgeEventObserver(std::shared_ptr<Observer<GpioLineRequest::Event>> observer);
+  
+  /// Start monitoring the pin for edges and notify the observers
+  void start();
+  
+  /// Stop monitoring the pin
+  void stop();
+
+private:
+  
+  GpioLineRequest m_line;
+  EncapsulatedObservable<GpioLineRequest::Event> m_edge_event_observable;
+  int m_wakeup_fd;
+  SamplingWorker m_worker;
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_GPIOCDEV_GPIOCDEVBINARYINPUT_H */
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file PiHWCtrl/gpiocdev/GpiocdevGpioBank.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_GPIOCDEV_GPIOCDEVGPIOBANK_H
+#define PIHWCTRL_GPIOCDEV_GPIOCDEVGPIOBANK_H
+
+#include <vector>
+#include <PiHWCtrl/HWInterfaces/ParallelOutput.h>
+#include <PiHWCtrl/HWInterfaces/ParallelInput.h>
+#include <PiHWCtrl/gpiocdev/GpioLineRequest.h>
+
+namespace PiHWCtrl {
+
+/**
+ * @class GpiocdevGpioBank
+ * 
+ * @brief
+ * Implementation of the ParallelOutput and ParallelInput interfaces using the
+ * GPIO character device
+ * 
+ * @details
+ * This class controls a group of the GPIOs 2-28 of the 40 pin interface of the
+ * Raspberry Pi as a single word. The bit i of the word corresponds to the i-th
+ * GPIO given at the constructor. Both writing and reading a word cost a single
+ * ioctl call, and the kernel applies all the values of a write together.
+ */
+class GpiocdevGpioBank : public ParallelOutput, public ParallelInput {
+  
+public:
+  
+  /**
+   * @brief Creates a GpiocdevGpioBank for the given GPIO pins
+   * 
+   * @param gpios
+   *    The GPIOs of the bank (maximum 32)
+   * @param direction
+   *    If the GPIOs are used as inputs or outputs. Banks of inputs cannot use
+   *    the write() method.
+   * @param chip
+   *    The number N of the /dev/gpiochipN device
+   * 
+   * @throws GpioAlreadyResearved
+   *    If any of the GPIOs is already reserved by another PiHWCtrl object
+   * @throws BadGpioNumber
+   *    If any of the GPIOs is out of the range 2-28
+   * @throws GpiocdevException
+   *    If there was any problem with the communication with the driver
+   */
+  GpiocdevGpioBank(const std::vector<int>& gpios,
+                   GpioLineRequest::Direction direction=GpioLineRequest::Direction::OUTPUT,
+                   int chip=0);
+  
+  /// Releases the GPIOs
+  virtual ~GpiocdevGpioBank() = default;
+  
+  /// Sets all the GPIOs to the bits of the given word (only for outputs)
+  void write(std::uint32_t word) override;
+  
+  /// Returns the states of all the GPIOs as the bits of a word
+  std::uint32_t read() const override;
+  
+private:
+  
+  GpioLineRequest m_lines;
+  GpioLineRequest::Direction m_direction;
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_GPIOCDEV_GPIOCDEVGPIOBANK_H */
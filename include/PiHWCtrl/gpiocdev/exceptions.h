@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file PiHWCtrl/gpiocdev/exceptions.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_GPIOCDEV_EXCEPTIONS_H
+#define PIHWCTRL_GPIOCDEV_EXCEPTIONS_H
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <PiHWCtrl/HWInterfaces/exceptions.h>
+
+namespace PiHWCtrl {
+
+class GpiocdevException : public Exception {
+public:
+  GpiocdevException(std::string action) : err_code(errno) {
+    appendMessage(action + ": ");
+    appendMessage(std::strerror(err_code));
+  }
+  int err_code;
+};
+
+class GpioChipOpenFailure : public GpiocdevException {
+public:
+  GpioChipOpenFailure(std::string chip_name)
+          : GpiocdevException("Failed to open GPIO chip " + chip_name),
+            chip_name(chip_name) {
+  }
+  std::string chip_name;
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_GPIOCDEV_EXCEPTIONS_H */
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file i2c/Endian.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_I2C_ENDIAN_H
+#define PIHWCTRL_I2C_ENDIAN_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace PiHWCtrl {
+
+/**
+ * @class Endian
+ * 
+ * @brief Describes how an integer register is stored in the bytes of a device
+ * 
+ * @details
+ * The type is used as template parameter of the typed register accesses (like
+ * the I2CBus::read<be16>()), so the size and the byte order are resolved at
+ * compile time and the conversion compiles to a few shifts.
+ * 
+ * @tparam T
+ *    The unsigned integer type of the value
+ * @tparam Size
+ *    The number of bytes of the register
+ * @tparam BigEndian
+ *    True if the first byte is the most significant
+ */
+template <typename T, std::size_t Size, bool BigEndian>
+struct Endian {
+  
+  using value_type = T;
+  static constexpr std::size_t size = Size;
+  
+  /// Converts the Size bytes to the value
+  static T decode(const std::uint8_t* bytes) {
+    T value = 0;
+    for (std::size_t i = 0; i < Size; ++i) {
+      value |= static_cast<T>(bytes[i]) << (8 * (BigEndian ? Size - 1 - i : i));
+    }
+    return value;
+  }
+  
+  /// Converts the value to Size bytes
+  static void encode(T value, std::uint8_t* bytes) {
+    for (std::size_t i = 0; i < Size; ++i) {
+      bytes[i] = value >> (8 * (BigEndian ? Size - 1 - i : i));
+    }
+  }
+  
+};
+
+template <typename T, std::size_t Size, bool BigEndian>
+constexpr std::size_t Endian<T, Size, BigEndian>::size;
+
+/// A single byte register
+using u8 = Endian<std::uint8_t, 1, true>;
+/// 16 bit registers, with the most or the least significant byte first
+using be16 = Endian<std::uint16_t, 2, true>;
+using le16 = Endian<std::uint16_t, 2, false>;
+/// 24 bit registers, stored in the lowest bits of a 32 bit integer
+using be24 = Endian<std::uint32_t, 3, true>;
+using le24 = Endian<std::uint32_t, 3, false>;
+/// 32 bit registers
+using be32 = Endian<std::uint32_t, 4, true>;
+using le32 = Endian<std::uint32_t, 4, false>;
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_I2C_ENDIAN_H */
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file i2c/I2CBatch.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_I2CBATCH_H
+#define PIHWCTRL_I2CBATCH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <functional>
+#include <PiHWCtrl/i2c/Endian.h>
+
+namespace PiHWCtrl {
+
+class I2CBus;
+
+/**
+ * @class I2CBatch
+ * 
+ * @brief Queues register reads and writes for one I2C device and submits them
+ * together
+ * 
+ * @details
+ * The batch is obtained from an I2CTransaction and it must be submitted while
+ * the transaction is alive. The queued operations are sent with as few
+ * transfers (for the kernel I2C_RDWR ioctls) as possible. Each read is a pair
+ * of messages (the register address write and the data read, with a repeated
+ * start between them), and the pairs are never split between two transfers.
+ * 
+ * Many adapters, like the i2c-bcm2835 of the Raspberry Pi, accept a read only
+ * as the last message of a transfer, so each read ends its transfer. The
+ * writes queued before a read go in the same transfer with it, and the
+ * consecutive writes are sent together (up to the limit of 42 messages of the
+ * kernel). A batch with N reads needs at least N transfers, which still saves
+ * the per-call overhead of the separate register accesses.
+ * 
+ * The read() returns a View to the memory of the batch where the data will be
+ * stored, which can be used after the submit(). The same batch can be
+ * submitted again (for example for polling a set of registers), without
+ * allocating any memory.
+ */
+class I2CBatch {
+  
+public:
+  
+  /// The data of a queued read
+  class View {
+  public:
+    /// Returns a pointer to the read bytes
+    const std::uint8_t* data() const;
+    /// Returns the number of read bytes
+    std::size_t size() const {
+      return m_size;
+    }
+    /// Converts the read bytes to an integer, with the first byte being the
+    /// most significant (or the least significant if invert is true)
+    template <typename T>
+    T as(bool invert=false) const {
+      const std::uint8_t* bytes = data();
+      T result = 0;
+      for (std::size_t i = 0; i < m_size; ++i) {
+        result = result << 8;
+        result |= bytes[invert ? m_size - i - 1 : i] & 0xFF;
+      }
+      return result;
+    }
+    /// Converts the read bytes to the value of the given Endian type (for
+    /// example get<be16>()), which must have the size of the read
+    template <typename E>
+    typename E::value_type get() const {
+      return E::decode(data());
+    }
+  private:
+    friend class I2CBatch;
+    View(const I2CBatch& batch, std::size_t offset, std::size_t size)
+            : m_batch(batch), m_offset(offset), m_size(size) {
+    }
+    std::reference_wrapper<const I2CBatch> m_batch;
+    std::size_t m_offset;
+    std::size_t m_size;
+  };
+  
+  /// Creates a batch for the device with the given address. Normally the
+  /// batches are obtained with the I2CTransaction::batch().
+  I2CBatch(I2CBus& bus, std::uint8_t address);
+  
+  /// Queues a read of size bytes starting from the given register
+  View read(std::uint8_t register_address, std::size_t size);
+  
+  /// Queues a write of the given bytes starting from the given register
+  void write(std::uint8_t register_address, const std::uint8_t* data, std::size_t size);
+  
+  /// Queues a write of the value to the register, with the same byte order as
+  /// the I2CBus::writeRegister()
+  template <typename T>
+  void writeRegister(std::uint8_t register_address, T value, bool invert=false) {
+    std::uint8_t buffer[sizeof(T)];
+    std::uint8_t* value_ptr = reinterpret_cast<std::uint8_t*>(&value);
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+      buffer[i] = invert ? value_ptr[sizeof(T) - i - 1] : value_ptr[i];
+    }
+    write(register_address, buffer, sizeof(T));
+  }
+  
+  /// Queues a write of the value to a register of the given Endian type (for
+  /// example write<be16>(reg, value))
+  template <typename E>
+  void write(std::uint8_t register_address, typename E::value_type value) {
+    std::uint8_t buffer[E::size];
+    E::encode(value, buffer);
+    write(register_address, buffer, E::size);
+  }
+  
+  /**
+   * @brief Performs all the queued operations
+   * 
+   * @throws I2CActionOutOfTransaction
+   *    If the transaction of the batch is not active
+   * @throws I2CReadRegisterException
+   *    If a transfer with a read fails (the register is the first of the
+   *    failed transfer)
+   * @throws I2CWriteRegisterException
+   *    If a transfer with only writes fails
+   */
+  void submit();
+  
+  /// Removes all the queued operations
+  void clear();
+  
+  /// Returns the number of I2C messages the queued operations need
+  std::size_t messageCount() const;
+  
+private:
+  
+  struct Operation {
+    bool read;
+    // The offset in m_data of the register address, followed by the data
+    std::size_t offset;
+    std::size_t size;
+  };
+  
+  std::reference_wrapper<I2CBus> m_bus;
+  std::uint8_t m_address;
+  std::vector<Operation> m_operations;
+  std::vector<std::uint8_t> m_data;
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_I2CBATCH_H */
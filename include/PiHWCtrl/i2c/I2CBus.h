@@ -27,9 +27,19 @@
 #include <cstdint>
 #include <mutex>
 #include <array>
-#include <unistd.h> // for read() and write()
+#include <map>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <PiHWCtrl/utils/GpioManager.h>
+#include <PiHWCtrl/utils/LatencyHistogram.h>
+#include <PiHWCtrl/i2c/I2CBusLock.h>
 #include <PiHWCtrl/i2c/I2CTransaction.h>
+#include <PiHWCtrl/i2c/I2CRequest.h>
+#include <PiHWCtrl/i2c/I2CRequestQueue.h>
+#include <PiHWCtrl/i2c/I2CTransport.h>
+#include <PiHWCtrl/i2c/Endian.h>
 #include <PiHWCtrl/i2c/exceptions.h>
 
 namespace PiHWCtrl {
@@ -38,34 +48,257 @@ class I2CBus {
   
 public:
   
+  /// The instrumentation statistics of the transfers with a device
+  struct DeviceStatistics {
+    /// The number of transactions
+    std::uint64_t transactions;
+    /// The bytes read from the device
+    std::uint64_t bytes_read;
+    /// The bytes written to the device, including the register addresses
+    std::uint64_t bytes_written;
+    /// The number of I2CReadRegisterException thrown
+    std::uint64_t read_errors;
+    /// The number of I2CWriteRegisterException thrown
+    std::uint64_t write_errors;
+    /// The duration of the system calls doing the transfers
+    LatencyHistogram::Snapshot transfer_latency;
+    /// The time the transactions waited for the bus
+    LatencyHistogram::Snapshot wait_time;
+  };
+  
+  /// Returns the bus of the /dev/i2c-1 adapter, which uses the GPIOs 2 and 3
+  /// of the Raspberry Pi header
   static std::shared_ptr<I2CBus> getSingleton();
   
+  /**
+   * @brief Returns the bus of the /dev/i2c-N adapter with the given number
+   * 
+   * @details
+   * All the calls with the same adapter number return the same instance. Each
+   * bus has its own lock, so transactions on different adapters (for example
+   * the ones created by the i2c-gpio or i2c-mux drivers) can run in parallel
+   * from different threads. Only the adapter 1 reserves the SDA and SCL GPIOs,
+   * because the pins of the rest of the adapters depend on the system setup.
+   * 
+   * @param adapter_number
+   *    The number N of the /dev/i2c-N adapter
+   * @throws I2CBusOpenFailure
+   *    If the adapter cannot be opened
+   */
+  static std::shared_ptr<I2CBus> open(int adapter_number);
+  
+  /**
+   * @brief Creates a bus which uses the given transport and registers it with
+   * the given adapter number
+   * 
+   * @details
+   * The following calls of the open() with the same adapter number return the
+   * created bus, so the modules created with this adapter number use it. This
+   * is mainly useful with the SimulatedI2CTransport, for running the modules
+   * without the hardware. No GPIO is reserved for the bus.
+   * 
+   * @throws Exception
+   *    If a bus with the given adapter number already exists
+   */
+  static std::shared_ptr<I2CBus> attach(int adapter_number, std::unique_ptr<I2CTransport> transport);
+  
   virtual ~I2CBus();
   
-  I2CTransaction startTransaction(std::uint8_t address);
+  /**
+   * @brief Starts a transaction with the device with the given address
+   * 
+   * @details
+   * The bus remembers which device its file is connected to, so the I2C_SLAVE
+   * ioctl is performed only when the transaction is for a different device
+   * than the previous one. Devices with a dedicated file (see the
+   * openDeviceFile()) never need it.
+   * 
+   * When the bus is busy, the REALTIME transactions get it before the
+   * BACKGROUND ones and the transactions with the same priority get it in the
+   * order they were requested (see I2CBusLock). The time waiting for the bus
+   * is recorded in the histogram of the device (see getWaitHistogram()).
+   * 
+   * @param address
+   *    The address of the device
+   * @param priority
+   *    The priority of the transaction. It should be REALTIME only for short
+   *    latency critical transactions, like actuator updates.
+   * @throws I2CDeviceConnectionFailure
+   *    If the connection to the device fails
+   */
+  I2CTransaction startTransaction(std::uint8_t address,
+                                  I2CBusLock::Priority priority=I2CBusLock::Priority::BACKGROUND);
   
+  /**
+   * @brief Executes a request asynchronously, with the worker thread of the bus
+   * 
+   * @details
+   * The worker is started the first time a request is submitted. It runs the
+   * requests of different devices in parallel, using the delays between their
+   * stages to serve the others, and it reports them in the order they were
+   * submitted (see I2CRequestQueue). The returned future gets the exception
+   * thrown by a stage of the request, if any.
+   */
+  std::future<void> submit(I2CRequest request);
   
-  template <std::size_t Size>
-  std::array<std::uint8_t, Size> readRegisterAsArray(std::uint8_t register_address) {
+  /// Executes a request asynchronously and calls the callback from the worker
+  /// thread when it finishes, with the exception thrown by a stage of the
+  /// request or null on success
+  void submit(I2CRequest request, I2CRequestQueue::Callback callback);
+  
+  /// Returns the histogram of the times the transactions with the device with
+  /// the given address waited for the bus
+  std::shared_ptr<LatencyHistogram> getWaitHistogram(std::uint8_t address);
+  
+  /**
+   * @brief Opens a dedicated file for the device with the given address
+   * 
+   * @details
+   * The file is connected to the device once, so all the transactions with it
+   * use it without any I2C_SLAVE ioctl, independently of the transactions with
+   * other devices. Calling it for a device which already has a dedicated file
+   * does nothing. It does nothing for buses which do not use the files of the
+   * kernel (see the attach()).
+   * 
+   * @throws I2CBusOpenFailure
+   *    If the file cannot be opened
+   * @throws I2CDeviceConnectionFailure
+   *    If the connection to the device fails
+   */
+  void openDeviceFile(std::uint8_t address);
+  
+  /// Returns the number of I2C_SLAVE ioctls which were avoided because the
+  /// file was already connected to the device of the transaction
+  std::uint64_t getSavedSlaveIoctls() const;
+  
+  /// Returns the number N of the /dev/i2c-N adapter of the bus
+  int getAdapterNumber() const;
+  
+  /**
+   * @brief Enables or disables the instrumentation of the transfers
+   * 
+   * @details
+   * When enabled, the bus counts for each device the transactions, the bytes
+   * transferred and the errors, and it records the duration of each transfer
+   * system call. When disabled (the default) each transfer only checks a
+   * pointer. The change applies to the transactions started after the call.
+   */
+  void setInstrumentationEnabled(bool enabled);
+  
+  /// Returns true if the instrumentation of the transfers is enabled
+  bool isInstrumentationEnabled() const;
+  
+  /// Returns the addresses of the devices which have instrumentation statistics
+  std::vector<std::uint8_t> getInstrumentedDevices();
+  
+  /// Returns the instrumentation statistics of the device with the given
+  /// address, which are all zero if no transaction with it was instrumented
+  DeviceStatistics getDeviceStatistics(std::uint8_t address);
+  
+  /// Clears the instrumentation statistics and the wait histograms of all the
+  /// devices
+  void resetStatistics();
+  
+  /**
+   * @brief Reads a block of consecutive registers in the given buffer
+   * 
+   * @details
+   * The device must support auto-incrementing the register address. If the
+   * transport supports combined transfers, the register address write and the
+   * data read are done with a repeated start between them, so no other master
+   * can access the device in between.
+   * 
+   * @param register_address
+   *    The first register to read
+   * @param buffer
+   *    The buffer to store the data (at least size bytes)
+   * @param size
+   *    The number of bytes to read
+   * @throws I2CActionOutOfTransaction
+   *    If it is called outside of a transaction
+   * @throws I2CReadRegisterException
+   *    If the transfer fails
+   */
+  void readRegisterBlock(std::uint8_t register_address, std::uint8_t* buffer, std::size_t size);
+  
+  
+  /**
+   * @brief Reads a register of the type described by the given Endian type
+   * 
+   * @details
+   * For example the read<be16>(reg) reads a 16 bit register with the most
+   * significant byte first. The conversion of the bytes is resolved at compile
+   * time.
+   * 
+   * @throws I2CActionOutOfTransaction
+   *    If it is called outside of a transaction
+   * @throws I2CReadRegisterException
+   *    If the transfer fails
+   */
+  template <typename E>
+  typename E::value_type read(std::uint8_t register_address) {
+    std::uint8_t buffer[E::size];
+    readRegisterBlock(register_address, buffer, E::size);
+    return E::decode(buffer);
+  }
+  
+  /**
+   * @brief Writes a register of the type described by the given Endian type
+   * 
+   * @throws I2CActionOutOfTransaction
+   *    If it is called outside of a transaction
+   * @throws I2CWriteRegisterException
+   *    If the transfer fails
+   */
+  template <typename E>
+  void write(std::uint8_t register_address, typename E::value_type value) {
     
-    // First check that the mutex is locked. If it is not means that we are not in
+    // First check that the bus is locked. If it is not means that we are not in
     // a valid transaction.
-    if (m_bus_mutex.try_lock()) {
-      m_bus_mutex.unlock();
+    if (!m_bus_lock.isLocked()) {
       throw I2CActionOutOfTransaction();
     }
     
-    // Write to the bus the register we want to read
-    if (write(m_bus_file, &register_address, 1) != 1) {
-      throw I2CReadRegisterException(register_address);
+    std::uint8_t buffer[E::size + 1];
+    buffer[0] = register_address;
+    E::encode(value, buffer + 1);
+    I2CMessage message {m_address, false, buffer, sizeof(buffer)};
+    if (!transfer(&message, 1)) {
+      recordWriteError();
+      throw I2CWriteRegisterException<typename E::value_type>(register_address, value);
     }
-    
-    // Read the register in the array
+  }
+  
+  /// @{
+  /**
+   * @brief SMBus transfers with the device of the transaction
+   * 
+   * @details
+   * They use the I2C_SMBUS ioctl if the adapter supports the protocol, or
+   * plain I2C messages otherwise. The words are sent with the least
+   * significant byte first, as the SMBus specifies. The readBlockData() stores
+   * up to 32 bytes in the buffer and returns their number.
+   * 
+   * @throws I2CActionOutOfTransaction
+   *    If it is called outside of a transaction
+   * @throws I2CReadRegisterException
+   *    If a transfer reading data fails
+   * @throws I2CWriteRegisterException
+   *    If a transfer writing data fails
+   */
+  std::uint8_t readByteData(std::uint8_t command);
+  void writeByteData(std::uint8_t command, std::uint8_t value);
+  std::uint16_t readWordData(std::uint8_t command);
+  void writeWordData(std::uint8_t command, std::uint16_t value);
+  std::uint16_t processCall(std::uint8_t command, std::uint16_t value);
+  std::size_t readBlockData(std::uint8_t command, std::uint8_t* buffer);
+  void writeBlockData(std::uint8_t command, const std::uint8_t* data, std::size_t size);
+  /// @}
+  
+  template <std::size_t Size>
+  std::array<std::uint8_t, Size> readRegisterAsArray(std::uint8_t register_address) {
     std::array<std::uint8_t, Size> buffer;
-    if (read(m_bus_file, buffer.begin(), Size) != Size) {
-      throw I2CReadRegisterException(register_address);
-    }
-    
+    readRegisterBlock(register_address, buffer.data(), Size);
     return buffer;
   }
   
@@ -94,10 +327,9 @@ public:
   template <typename T>
   void writeRegister(std::uint8_t register_address, T value, bool invert=false) {
     
-    // First check that the mutex is locked. If it is not means that we are not in
+    // First check that the bus is locked. If it is not means that we are not in
     // a valid transaction.
-    if (m_bus_mutex.try_lock()) {
-      m_bus_mutex.unlock();
+    if (!m_bus_lock.isLocked()) {
       throw I2CActionOutOfTransaction();
     }
     
@@ -114,7 +346,9 @@ public:
     }
     
     // Write the message to the bus
-    if (write(m_bus_file, buffer.begin(), sizeof(buffer)) != sizeof(buffer)) {
+    I2CMessage message {m_address, false, buffer.data(), buffer.size()};
+    if (!transfer(&message, 1)) {
+      recordWriteError();
       throw I2CWriteRegisterException<T>(register_address, value);
     }
     
@@ -122,12 +356,59 @@ public:
   
 private:
   
-  I2CBus();
+  // The batches use directly the transfer() of the bus
+  friend class I2CBatch;
+  
+  I2CBus(int adapter_number, std::unique_ptr<I2CTransport> transport);
+  
+  // Performs the messages with the transport, recording the instrumentation
+  // statistics if the transaction is instrumented
+  bool transfer(I2CMessage* messages, std::size_t count);
+  
+  // Performs an SMBus transfer with the device of the transaction, throwing
+  // the read or write exception on failure
+  void smbusTransfer(SMBusProtocol protocol, bool read, std::uint8_t command, SMBusData& data);
+  
+  struct DeviceCounters {
+    std::atomic<std::uint64_t> transactions {0};
+    std::atomic<std::uint64_t> bytes_read {0};
+    std::atomic<std::uint64_t> bytes_written {0};
+    std::atomic<std::uint64_t> read_errors {0};
+    std::atomic<std::uint64_t> write_errors {0};
+    LatencyHistogram transfer_latency;
+  };
+  
+  // The error counting of the current transaction, which does nothing if the
+  // transaction is not instrumented
+  
+  void recordReadError() {
+    if (m_current_counters) {
+      m_current_counters->read_errors.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  
+  void recordWriteError() {
+    if (m_current_counters) {
+      m_current_counters->write_errors.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
   
   std::unique_ptr<GpioManager::GpioReservation> m_sda_gpio_reservation;
   std::unique_ptr<GpioManager::GpioReservation> m_scl_gpio_reservation;
-  int m_bus_file;
-  std::mutex m_bus_mutex;
+  int m_adapter_number;
+  std::unique_ptr<I2CTransport> m_transport;
+  I2CBusLock m_bus_lock;
+  // Protects the maps with the statistics of the devices
+  std::mutex m_statistics_mutex;
+  std::map<std::uint8_t, std::shared_ptr<LatencyHistogram>> m_wait_histograms;
+  std::atomic<bool> m_instrumentation_enabled {false};
+  std::map<std::uint8_t, std::shared_ptr<DeviceCounters>> m_device_counters;
+  // The counters of the current transaction, or null if it is not instrumented
+  DeviceCounters* m_current_counters = nullptr;
+  std::uint8_t m_address;
+  std::mutex m_request_queue_mutex;
+  // Declared last, so the worker stops before anything it uses is destroyed
+  std::unique_ptr<I2CRequestQueue> m_request_queue;
 
 };
 
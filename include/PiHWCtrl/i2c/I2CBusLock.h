@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file PiHWCtrl/i2c/I2CBusLock.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_I2CBUSLOCK_H
+#define PIHWCTRL_I2CBUSLOCK_H
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <condition_variable>
+
+namespace PiHWCtrl {
+
+/**
+ * @class I2CBusLock
+ * 
+ * @brief
+ * Lock which gives the I2C bus to its waiters based on their priority
+ * 
+ * @details
+ * When the bus is released it is given to the REALTIME waiters before the
+ * BACKGROUND ones, and to the waiters of the same priority in the order they
+ * asked for it. This way a time critical transaction (like an actuator update)
+ * waits at most for the transaction currently running, and not for all the
+ * sensor transactions queued before it. Note that the BACKGROUND waiters do not
+ * get the bus for as long as there are REALTIME waiters.
+ */
+class I2CBusLock {
+  
+public:
+  
+  enum class Priority {
+    REALTIME, BACKGROUND
+  };
+  
+  I2CBusLock() = default;
+  
+  virtual ~I2CBusLock() = default;
+  
+  /// Blocks until the bus is given to the caller
+  void lock(Priority priority=Priority::BACKGROUND);
+  
+  /// Releases the bus and gives it to the next waiter
+  void unlock();
+  
+  /// Returns true if some thread holds the lock
+  bool isLocked() const;
+  
+private:
+  
+  mutable std::mutex m_mutex;
+  std::condition_variable m_condition;
+  bool m_locked = false;
+  // The next ticket to give and the next ticket to serve for each priority
+  std::array<std::uint64_t, 2> m_next_ticket {{0, 0}};
+  std::array<std::uint64_t, 2> m_serving {{0, 0}};
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_I2CBUSLOCK_H */
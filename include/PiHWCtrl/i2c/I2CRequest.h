@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file i2c/I2CRequest.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_I2CREQUEST_H
+#define PIHWCTRL_I2CREQUEST_H
+
+#include <cstdint>
+#include <chrono>
+#include <vector>
+#include <functional>
+#include <PiHWCtrl/i2c/I2CBusLock.h>
+
+namespace PiHWCtrl {
+
+class I2CBus;
+
+/**
+ * @class I2CRequest
+ * 
+ * @brief
+ * A sequence of operations with an I2C device, executed asynchronously by the
+ * worker of the bus (see I2CBus::submit())
+ * 
+ * @details
+ * Each stage of the request is a function which is called in a transaction
+ * with the device, so it can use directly the read and write methods of the
+ * bus. It returns what the worker should do next: continue with the next stage
+ * after a delay (for example the conversion time of an ADC), or repeat the
+ * same stage after a delay (for example polling a status register). While a
+ * request waits, the worker runs the stages of the other requests, so the
+ * conversions of different devices overlap.
+ * 
+ * The stages must not block and must not start transactions themselves.
+ */
+class I2CRequest {
+  
+public:
+  
+  using Duration = std::chrono::microseconds;
+  
+  /// What the worker does after a stage
+  struct Next {
+    /// The time to wait before the following stage
+    Duration delay;
+    /// If true the same stage is executed again
+    bool repeat;
+  };
+  
+  using Stage = std::function<Next(I2CBus&)>;
+  
+  /// Continue with the next stage, after the given delay
+  static Next proceed(Duration delay=Duration::zero()) {
+    return Next{delay, false};
+  }
+  
+  /// Execute the same stage again, after the given delay. Even without a delay
+  /// it is executed in the next round of the worker, after the stages of the
+  /// other ready requests.
+  static Next repeat(Duration delay=Duration::zero()) {
+    return Next{delay, true};
+  }
+  
+  explicit I2CRequest(std::uint8_t address,
+                      I2CBusLock::Priority priority=I2CBusLock::Priority::BACKGROUND)
+          : m_address(address), m_priority(priority) {
+  }
+  
+  /// Appends a stage to the request
+  I2CRequest& then(Stage stage) {
+    m_stages.emplace_back(std::move(stage));
+    return *this;
+  }
+  
+  std::uint8_t getAddress() const {
+    return m_address;
+  }
+  
+  I2CBusLock::Priority getPriority() const {
+    return m_priority;
+  }
+  
+  const std::vector<Stage>& getStages() const {
+    return m_stages;
+  }
+  
+private:
+  
+  std::uint8_t m_address;
+  I2CBusLock::Priority m_priority;
+  std::vector<Stage> m_stages;
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_I2CREQUEST_H */
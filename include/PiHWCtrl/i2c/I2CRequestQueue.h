@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file i2c/I2CRequestQueue.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_I2CREQUESTQUEUE_H
+#define PIHWCTRL_I2CREQUESTQUEUE_H
+
+#include <memory>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <chrono>
+#include <PiHWCtrl/i2c/I2CRequest.h>
+
+namespace PiHWCtrl {
+
+class I2CBus;
+
+/**
+ * @class I2CRequestQueue
+ * 
+ * @brief
+ * The worker thread executing the asynchronous requests of an I2C bus
+ * 
+ * @details
+ * Each round the worker executes the stages of all the requests which are not
+ * waiting for a delay. The stages for the same device are coalesced in a single
+ * transaction and the REALTIME requests go first. While a request waits (for
+ * example for an ADC conversion), the stages of the other requests keep the bus
+ * busy, so polling many devices approaches the throughput of the wire.
+ * 
+ * The callbacks are called from the worker thread in the order the requests
+ * were submitted, even if a later request finished first. The bus lock is not
+ * held while they run, so they can use the bus synchronously, but they must be
+ * short, because they delay all the other requests.
+ * 
+ * Use it through the I2CBus::submit(), which creates the queue of the bus when
+ * it is first needed.
+ */
+class I2CRequestQueue {
+  
+public:
+  
+  /// Receives null if the request finished successfully, or the exception
+  /// thrown by its stage otherwise
+  using Callback = std::function<void(std::exception_ptr)>;
+  
+  /// Starts the worker thread
+  explicit I2CRequestQueue(I2CBus& bus);
+  
+  /// Stops the worker thread. The callbacks of the requests which did not
+  /// finish receive an Exception.
+  virtual ~I2CRequestQueue();
+  
+  /// Queues a request. The callback is called when it finishes.
+  void submit(I2CRequest request, Callback callback);
+  
+private:
+  
+  using Clock = std::chrono::steady_clock;
+  
+  struct Pending {
+    I2CRequest request;
+    Callback callback;
+    std::size_t stage;
+    Clock::time_point ready_time;
+    std::exception_ptr error;
+    bool done;
+  };
+  
+  void workerLoop();
+  
+  // Runs the stages of the request until it finishes, fails or has to wait
+  void execute(Pending& pending);
+  
+  I2CBus& m_bus;
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  // The requests in the order they were submitted
+  std::deque<std::shared_ptr<Pending>> m_requests;
+  bool m_stopping = false;
+  std::thread m_worker;
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_I2CREQUESTQUEUE_H */
@@ -24,30 +24,50 @@
 #define PIHWCTRL_I2CTRANSACTION_H
 
 #include <mutex>
+#include <cstdint>
+#include <PiHWCtrl/i2c/I2CBatch.h>
+#include <PiHWCtrl/i2c/I2CBusLock.h>
 
 namespace PiHWCtrl {
 
+class I2CBus;
+
 class I2CTransaction {
   
 public:
   
-  I2CTransaction(std::mutex& mutex) : m_lock(mutex) {
+  /// Blocks until the bus lock is given to the transaction, based on the
+  /// given priority
+  I2CTransaction(I2CBusLock& bus_lock, I2CBusLock::Priority priority,
+                 I2CBus& bus, std::uint8_t address)
+          : m_lock(bus_lock, std::defer_lock), m_bus(&bus), m_address(address) {
+    bus_lock.lock(priority);
+    m_lock = std::unique_lock<I2CBusLock>(bus_lock, std::adopt_lock);
   }
   
   I2CTransaction(I2CTransaction&& other) = default;
   I2CTransaction& operator=(I2CTransaction&& other) = default;
   
   virtual ~I2CTransaction() {
-    m_lock.unlock();
+    if (m_lock.owns_lock()) {
+      m_lock.unlock();
+    }
+  }
+  
+  /// Returns a new batch for queueing operations to the device of the
+  /// transaction. The batch must be submitted before the transaction ends.
+  I2CBatch batch() {
+    return I2CBatch {*m_bus, m_address};
   }
   
 private:
   
-  std::unique_lock<std::mutex> m_lock;
+  std::unique_lock<I2CBusLock> m_lock;
+  I2CBus* m_bus;
+  std::uint8_t m_address;
   
 };
 
 } // end of namespace PiHWCtrl
 
 #endif /* PIHWCTRL_I2CTRANSACTION_H */
-
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file i2c/I2CTransport.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_I2CTRANSPORT_H
+#define PIHWCTRL_I2CTRANSPORT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+
+namespace PiHWCtrl {
+
+/// A single message of an I2C transfer (similar to the i2c_msg of the kernel)
+struct I2CMessage {
+  /// The address of the device
+  std::uint8_t address;
+  /// True for reading from the device, false for writing to it
+  bool read;
+  /// The data to write, or the buffer to store the read data
+  std::uint8_t* data;
+  /// The number of bytes to transfer
+  std::size_t size;
+};
+
+/// The SMBus protocols of the I2CTransport::smbusTransfer()
+enum class SMBusProtocol {
+  BYTE_DATA,  ///< A byte read from or written to a command (register)
+  WORD_DATA,  ///< A 16 bit word read from or written to a command
+  PROC_CALL,  ///< A word written to a command followed by a word read
+  BLOCK_DATA  ///< A block of up to 32 bytes, preceded by its length
+};
+
+/// The maximum number of data bytes of an SMBus block
+constexpr std::size_t SMBUS_BLOCK_MAX = 32;
+
+/// The data of an SMBus transfer, with the layout of the i2c_smbus_data of the
+/// kernel. The bytes are in data[0], the words in data[0] (low byte) and
+/// data[1] (high byte), as they are sent on the bus, and the blocks in data[1]
+/// and after, with their length in data[0].
+using SMBusData = std::array<std::uint8_t, SMBUS_BLOCK_MAX + 2>;
+
+/**
+ * @class I2CTransport
+ * 
+ * @brief Interface of the layer which moves the bytes of an I2CBus
+ * 
+ * @details
+ * The I2CBus handles the transactions, the locking and the instrumentation and
+ * it uses a transport for the actual transfers. The LinuxI2CTransport uses the
+ * /dev/i2c-N files of the kernel and the SimulatedI2CTransport uses in-process
+ * models of the devices. The I2CBus calls the transport only while holding its
+ * lock, so the transports do not need to be thread safe.
+ */
+class I2CTransport {
+  
+public:
+  
+  /// The maximum number of messages of a single transfer, which is the limit
+  /// of the I2C_RDWR ioctl of the kernel
+  static constexpr std::size_t MAX_MESSAGES = 42;
+  
+  virtual ~I2CTransport() = default;
+  
+  /**
+   * @brief Prepares the transport for transfers with the given device
+   * 
+   * @details
+   * It is called at the beginning of every transaction.
+   * 
+   * @throws I2CDeviceConnectionFailure
+   *    If the device cannot be selected
+   */
+  virtual void selectDevice(std::uint8_t address) = 0;
+  
+  /**
+   * @brief Performs the given messages
+   * 
+   * @details
+   * If the transport supports it, the messages are performed as a single
+   * combined transfer, with repeated starts between them. The number of
+   * messages must not exceed the MAX_MESSAGES.
+   * 
+   * @return
+   *    True if all the messages were transferred. On failure errno is set to
+   *    the reason.
+   */
+  virtual bool transfer(I2CMessage* messages, std::size_t count) = 0;
+  
+  /**
+   * @brief Performs an SMBus transfer with the given device
+   * 
+   * @details
+   * The default implementation builds the SMBus transfer from plain I2C
+   * messages with the transfer(). Transports with native SMBus support
+   * override it. The read flag is ignored for the PROC_CALL, which always
+   * writes and then reads a word. The block reads read SMBUS_BLOCK_MAX bytes
+   * after the length, as the plain I2C messages cannot stop at the length sent
+   * by the device.
+   * 
+   * @return
+   *    True if the transfer succeeded. On failure errno is set to the reason.
+   */
+  virtual bool smbusTransfer(std::uint8_t address, SMBusProtocol protocol, bool read,
+                             std::uint8_t command, SMBusData& data);
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_I2CTRANSPORT_H */
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file i2c/LinuxI2CTransport.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_LINUXI2CTRANSPORT_H
+#define PIHWCTRL_LINUXI2CTRANSPORT_H
+
+#include <cstdint>
+#include <map>
+#include <atomic>
+#include <PiHWCtrl/i2c/I2CTransport.h>
+
+namespace PiHWCtrl {
+
+/**
+ * @class LinuxI2CTransport
+ * 
+ * @brief I2C transport using the /dev/i2c-N files of the kernel
+ * 
+ * @details
+ * If the adapter supports plain I2C messages, each transfer is a single
+ * I2C_RDWR ioctl. Otherwise the messages are performed one by one with write()
+ * and read() calls, to the device selected with the I2C_SLAVE ioctl. The SMBus
+ * transfers use the I2C_SMBUS ioctl when the adapter supports the protocol.
+ */
+class LinuxI2CTransport : public I2CTransport {
+  
+public:
+  
+  /**
+   * @brief Opens the /dev/i2c-N file of the given adapter
+   * 
+   * @throws I2CBusOpenFailure
+   *    If the file cannot be opened
+   */
+  LinuxI2CTransport(int adapter_number);
+  
+  virtual ~LinuxI2CTransport();
+  
+  /// Connects the file of the transport to the device, unless it is already
+  /// connected to it or the device has a dedicated file
+  void selectDevice(std::uint8_t address) override;
+  
+  bool transfer(I2CMessage* messages, std::size_t count) override;
+  
+  bool smbusTransfer(std::uint8_t address, SMBusProtocol protocol, bool read,
+                     std::uint8_t command, SMBusData& data) override;
+  
+  /// See I2CBus::openDeviceFile()
+  void openDeviceFile(std::uint8_t address);
+  
+  /// See I2CBus::getSavedSlaveIoctls()
+  std::uint64_t getSavedSlaveIoctls() const;
+  
+private:
+  
+  int m_adapter_number;
+  int m_bus_file;
+  // The address the m_bus_file is connected to (-1 for none)
+  int m_bus_file_address = -1;
+  // The files dedicated to a single device
+  std::map<std::uint8_t, int> m_device_files;
+  // The file used by the current transaction
+  int m_current_file;
+  std::atomic<std::uint64_t> m_saved_slave_ioctls {0};
+  // The I2C_FUNC flags of the adapter
+  unsigned long m_funcs = 0;
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_LINUXI2CTRANSPORT_H */
@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file i2c/SimulatedI2CDevices.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_SIMULATEDI2CDEVICES_H
+#define PIHWCTRL_SIMULATEDI2CDEVICES_H
+
+#include <cstdint>
+#include <array>
+#include <mutex>
+#include <PiHWCtrl/i2c/SimulatedI2CTransport.h>
+
+namespace PiHWCtrl {
+
+/**
+ * @class SimulatedRegisterMap
+ * 
+ * @brief Model of a device with 256 8-bit registers
+ * 
+ * @details
+ * The first byte written to the device sets the register pointer and the rest
+ * are written to the registers starting from it. The reads start from the
+ * register pointer. If the device auto-increments, the pointer moves to the
+ * next register after each byte.
+ */
+class SimulatedRegisterMap : public SimulatedI2CDevice {
+  
+public:
+  
+  virtual ~SimulatedRegisterMap() = default;
+  
+  bool write(const std::uint8_t* data, std::size_t size) override;
+  
+  bool read(std::uint8_t* data, std::size_t size) override;
+  
+  /// Returns the current value of the given register
+  std::uint8_t getRegister(std::uint8_t reg) const;
+  
+  /// Sets the value of the given register, without triggering the behavior of
+  /// a write from the bus
+  void setRegister(std::uint8_t reg, std::uint8_t value);
+  
+protected:
+  
+  /// Called when a register is written from the bus, after its value is
+  /// updated. The m_mutex is already locked.
+  virtual void registerWritten(std::uint8_t reg, std::uint8_t value);
+  
+  /// Returns true if the register pointer moves to the next register after
+  /// each byte. The m_mutex is already locked.
+  virtual bool autoIncrement() const;
+  
+  mutable std::mutex m_mutex;
+  std::array<std::uint8_t, 256> m_registers {};
+  
+private:
+  
+  std::uint8_t m_pointer = 0;
+  
+};
+
+/**
+ * @class SimulatedADS1115
+ * 
+ * @brief Model of the ADS1115 analog to digital converter
+ * 
+ * @details
+ * The conversions complete immediately and they use the voltages set with the
+ * setInputVoltage(), according the multiplexer and the gain of the config
+ * register. In continuous mode the conversion register always contains the
+ * conversion of the current voltages.
+ */
+class SimulatedADS1115 : public SimulatedI2CDevice {
+  
+public:
+  
+  SimulatedADS1115() = default;
+  
+  virtual ~SimulatedADS1115() = default;
+  
+  bool write(const std::uint8_t* data, std::size_t size) override;
+  
+  bool read(std::uint8_t* data, std::size_t size) override;
+  
+  /// Sets the voltage (relative to GND) of the given input (0 to 3)
+  void setInputVoltage(int input, float voltage);
+  
+  /// Returns the current value of the config register
+  std::uint16_t getConfig() const;
+  
+private:
+  
+  // Computes the conversion of the current voltages. The mutex must be locked.
+  std::int16_t convert() const;
+  
+  mutable std::mutex m_mutex;
+  std::uint8_t m_pointer = 0;
+  std::array<float, 4> m_voltages {};
+  std::int16_t m_conversion = 0;
+  // The config register, without the operational status bit
+  std::uint16_t m_config = 0x0583;
+  std::uint16_t m_lo_thresh = 0x8000;
+  std::uint16_t m_hi_thresh = 0x7FFF;
+  
+};
+
+/**
+ * @class SimulatedBMP180
+ * 
+ * @brief Model of the BMP180 pressure sensor
+ * 
+ * @details
+ * The calibration coefficients and the default uncompensated measurements are
+ * the ones of the example of the datasheet, which result to a temperature of
+ * 15.0 C and a pressure of 69964 Pa (in the ultra low power mode). The
+ * measurements complete immediately.
+ */
+class SimulatedBMP180 : public SimulatedRegisterMap {
+  
+public:
+  
+  SimulatedBMP180();
+  
+  virtual ~SimulatedBMP180() = default;
+  
+  /// Sets the uncompensated temperature and pressure the measurements return
+  void setUncompensatedValues(std::uint16_t temperature, std::uint32_t pressure);
+  
+protected:
+  
+  void registerWritten(std::uint8_t reg, std::uint8_t value) override;
+  
+private:
+  
+  std::uint16_t m_temperature = 27898;
+  std::uint32_t m_pressure = 23843;
+  
+};
+
+/**
+ * @class SimulatedPCA9685
+ * 
+ * @brief Model of the PCA9685 PWM controller
+ * 
+ * @details
+ * The registers start with their power on values. The writes to the ALL_LED
+ * registers are applied to the registers of all the channels and the register
+ * pointer auto-increments only if the AI bit of the MODE1 register is set.
+ */
+class SimulatedPCA9685 : public SimulatedRegisterMap {
+  
+public:
+  
+  SimulatedPCA9685();
+  
+  virtual ~SimulatedPCA9685() = default;
+  
+  /// Returns the value of the LED_ON registers of the given channel
+  std::uint16_t getLedOn(int channel) const;
+  
+  /// Returns the value of the LED_OFF registers of the given channel
+  std::uint16_t getLedOff(int channel) const;
+  
+protected:
+  
+  void registerWritten(std::uint8_t reg, std::uint8_t value) override;
+  
+  bool autoIncrement() const override;
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_SIMULATEDI2CDEVICES_H */
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file i2c/SimulatedI2CTransport.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_SIMULATEDI2CTRANSPORT_H
+#define PIHWCTRL_SIMULATEDI2CTRANSPORT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <PiHWCtrl/i2c/I2CTransport.h>
+
+namespace PiHWCtrl {
+
+/**
+ * @class SimulatedI2CDevice
+ * 
+ * @brief Interface of the in-process models of I2C devices
+ * 
+ * @details
+ * The SimulatedI2CTransport calls the write() for the messages written to the
+ * device and the read() for the messages read from it, in the order of the
+ * messages of a transfer. Returning false simulates a NACK from the device.
+ * The methods are called from the thread doing the transfer, so the models
+ * must protect the state they share with other methods.
+ */
+class SimulatedI2CDevice {
+  
+public:
+  
+  virtual ~SimulatedI2CDevice() = default;
+  
+  /// Handles a message which writes the given data to the device
+  virtual bool write(const std::uint8_t* data, std::size_t size) = 0;
+  
+  /// Handles a message which reads the given number of bytes from the device
+  virtual bool read(std::uint8_t* data, std::size_t size) = 0;
+  
+};
+
+/**
+ * @class SimulatedI2CTransport
+ * 
+ * @brief I2C transport which transfers the messages to in-process device models
+ * 
+ * @details
+ * It can be used for running the modules without the hardware, by attaching
+ * it to an adapter number with the I2CBus::attach(). The messages to addresses
+ * without a device fail with EREMOTEIO, like the NACK of a real bus.
+ * 
+ * If a bus frequency is given, each transfer takes the time it would take on a
+ * real bus, counting nine clock cycles for each byte (including the address
+ * bytes) and one for each start and stop condition. Note that very short
+ * transfers might take longer, because of the sleep granularity of the system.
+ */
+class SimulatedI2CTransport : public I2CTransport {
+  
+public:
+  
+  /// The clock frequencies of the standard, fast and fast plus modes
+  static constexpr unsigned int STANDARD_MODE = 100000;
+  static constexpr unsigned int FAST_MODE = 400000;
+  static constexpr unsigned int FAST_MODE_PLUS = 1000000;
+  
+  /**
+   * @brief Creates a transport without any device
+   * 
+   * @param bus_frequency
+   *    The clock frequency of the simulated bus in Hz, or zero for transfers
+   *    which take no time
+   */
+  SimulatedI2CTransport(unsigned int bus_frequency=0);
+  
+  virtual ~SimulatedI2CTransport() = default;
+  
+  /// Adds the given device model to the bus, at the given address
+  void addDevice(std::uint8_t address, std::shared_ptr<SimulatedI2CDevice> device);
+  
+  /// Does nothing, as the messages contain the address of the device
+  void selectDevice(std::uint8_t address) override;
+  
+  bool transfer(I2CMessage* messages, std::size_t count) override;
+  
+private:
+  
+  unsigned int m_bus_frequency;
+  std::map<std::uint8_t, std::shared_ptr<SimulatedI2CDevice>> m_devices;
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_SIMULATEDI2CTRANSPORT_H */
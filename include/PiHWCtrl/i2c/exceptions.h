@@ -82,6 +82,14 @@ public:
     appendMessage(message.str());
     appendMessage(std::strerror(err_code));
   }
+  // For the writes which have no value (only the register address)
+  I2CWriteRegisterException(std::int8_t register_address)
+          : register_address(register_address), err_code(errno), value() {
+    std::stringstream message;
+    message << "Failed to write register " << (int)register_address << ": ";
+    appendMessage(message.str());
+    appendMessage(std::strerror(err_code));
+  }
   std::int8_t register_address;
   int err_code;
   T value;
@@ -27,12 +27,16 @@
 #include <memory>
 #include <mutex>
 #include <map>
-#include <atomic>
+#include <future>
 #include <PiHWCtrl/HWInterfaces/AnalogInput.h>
+#include <PiHWCtrl/HWInterfaces/Observable.h>
 #include <PiHWCtrl/utils/EncapsulatedObservable.h>
+#include <PiHWCtrl/utils/SamplingWorker.h>
 
 namespace PiHWCtrl {
 
+class I2CBus;
+
 /**
  * @class ADS1115
  * 
@@ -59,8 +63,9 @@ namespace PiHWCtrl {
  * provides a CONTINUOUS mode, which continuously repeats the measurement. This
  * class hides from the user the fact of a single measurement per time and it
  * provides its own continuous method, which internally switches the multiplexer
- * to chose all the input combinations for which the values are requested. At
- * the moment the native continuous mode is not accessible.
+ * to chose all the input combinations for which the values are requested. The
+ * native continuous mode of a single input is available with the
+ * startContinuous(), when the ALERT/RDY pin is connected to a GPIO.
  * 
  * TThe ADS1115 class allows to use different gain for each of the differential
  * inputs, which can be set using the setGain(input, gain) method. It also
@@ -144,16 +149,19 @@ public:
    * measurements but take more time.
    * 
    * Note that only a single instance of ADS1115 can be created for each
-   * different address pin.
+   * different address pin and I2C adapter.
    * 
    * @param addr
    *    The pin at which the ADDR pin of the ADS1115 is connected
    * @param data_rate
    *    The data rate to set the device
+   * @param i2c_adapter
+   *    The number N of the /dev/i2c-N adapter the device is connected to
    * @return 
    */
   static std::unique_ptr<ADS1115> factory(AddressPin addr=AddressPin::GND,
-                                          DataRate data_rate=DataRate::DR_128_SPS);
+                                          DataRate data_rate=DataRate::DR_128_SPS,
+                                          int i2c_adapter=1);
   
   /// Allows other ADS1115 instances to be created for the same address
   virtual ~ADS1115();
@@ -188,6 +196,23 @@ public:
   /// Reads a single conversion for the given differential input
   float readConversion(Input input);
   
+  /**
+   * @brief Reads a single conversion asynchronously, with the worker thread of
+   * the I2C bus
+   * 
+   * @details
+   * While the device converts, the worker serves the requests of the other
+   * devices of the bus, so the conversions of several ADCs (or of an ADC and
+   * other sensors) overlap instead of each thread sleeping for its own. The
+   * automatic gain mode works like with the readConversion(), repeating the
+   * conversion when the gain changes. The ADS1115 must not be destroyed before
+   * the returned future is ready.
+   * 
+   * @throws InvalidState
+   *    If the device is in CONTINUOUS mode
+   */
+  std::future<float> submitConversion(Input input);
+  
   /// Returns an AnalogInput for accessing the requested differential input
   std::unique_ptr<AnalogInput<float>> conversionAnalogInput(Input input);
   
@@ -202,23 +227,71 @@ public:
    * This mode will continuously check for which inputs have been registered
    * observers, it will perform the measurements and will notify the observers.
    * 
-   * The parameter power_down_ms will can be used for applications that high
-   * sampling rate is not required. The device will be put in power down mode
-   * for this number of milliseconds every time a set of measurements is
-   * performed. This can be used to limit the current consumption of the device.
+   * The parameter period_ms can be used for applications that high sampling
+   * rate is not required. The measurement cycles start at absolute deadlines,
+   * period_ms apart (so the conversion times do not add to the period), and
+   * the device stays in power down mode for the rest of each period. This can
+   * be used to limit the current consumption of the device. With zero (the
+   * default) a new cycle starts as soon as the previous finishes.
+   * 
+   * @param period_ms
+   *    The time in milliseconds between the starts of two measurement cycles
+   */
+  void start(int period_ms=0);
+  
+  /// Returns the statistics of the achieved period of the continuous
+  /// measurement mode, or null if it was never started
+  std::shared_ptr<PeriodStatistics> getStatistics() const;
+  
+  /**
+   * @brief Starts the native continuous conversion mode of the device, for the
+   * given input
+   * 
+   * @details
+   * The comparator is configured as a conversion ready signal (the MSB of the
+   * HI_THRESH register set and of the LO_THRESH register cleared), so the
+   * ALERT/RDY pin gives a pulse at the end of every conversion. The pulse is
+   * active high, so the pin (which is open drain and needs a pull-up resistor)
+   * should be connected to a GPIO input which notifies once for each of its
+   * rising edges, like a GpiocdevBinaryInput with Edge::RISING. Every
+   * notification is treated as a ready conversion, whatever its value, so the
+   * input must not notify the falling edges too. Each conversion is read as
+   * soon as it is ready and the observers of the input are notified with it,
+   * from the thread notifying the alert_rdy events. This gives the full data
+   * rate of the device.
    * 
-   * @param power_down_ms
-   *    The time in milliseconds to power down after each measurements cycle
+   * The pulse lasts only about 8 microseconds, so the sysfs GpioBinaryInput
+   * cannot be used: its edge mode reads the value of the pin after the pulse
+   * is over and its polling mode misses most of the pulses.
+   * 
+   * The conversions use the current gain of the input. The automatic gain mode
+   * does not adjust it in continuous mode. While in continuous mode the
+   * readConversion() and the start() cannot be used. Call stop() to return to
+   * single shot mode.
+   * 
+   * @param input
+   *    The differential input to convert
+   * @param alert_rdy
+   *    The observable of the GPIO the ALERT/RDY pin is connected to, which must
+   *    outlive the continuous mode
+   * @throws InvalidState
+   *    If the device is already in continuous mode or the start() is running
    */
-  void start(int power_down_ms=0);
+  void startContinuous(Input input, Observable<bool>& alert_rdy);
   
-  /// Stop the continuous measurement mode
+  /// Stop the continuous measurement mode (both the one of the start() and the
+  /// native one of the startContinuous(), returning the device to single shot
+  /// mode)
   void stop();
   
 private:
   
-  ADS1115(AddressPin addr, DataRate data_rate);
+  // Reads the conversions when the ALERT/RDY pin signals they are ready
+  class ReadyObserver;
+  
+  ADS1115(AddressPin addr, DataRate data_rate, int i2c_adapter);
   
+  std::shared_ptr<I2CBus> m_bus;
   std::uint8_t m_addr;
   mutable std::mutex m_mutex;
   std::map<Input, Gain> m_input_gain_map;
@@ -226,7 +299,9 @@ private:
   Mode m_mode;
   DataRate m_data_rate;
   std::map<Input, EncapsulatedObservable<float>> m_input_observable_map;
-  std::atomic<bool> m_observing {false};
+  SamplingWorker m_worker;
+  std::shared_ptr<ReadyObserver> m_ready_observer;
+  Observable<bool>::Subscription m_ready_subscription;
   
 }; // end of class ADS1115
 
@@ -27,12 +27,15 @@
 #include <memory>
 #include <chrono>
 #include <mutex>
-#include <atomic>
+#include <string>
 #include <PiHWCtrl/HWInterfaces/AnalogInput.h>
 #include <PiHWCtrl/utils/EncapsulatedObservable.h>
+#include <PiHWCtrl/utils/SamplingWorker.h>
 
 namespace PiHWCtrl {
 
+class I2CBus;
+
 /**
  * @class BMP180
  * 
@@ -78,14 +81,25 @@ public:
    * 
    * @details
    * This call will perform a soft reset to the device. Only a single instance
-   * of the BMP180 can exist at a time. If it needs to be accessed from multiple
+   * of the BMP180 can exist at a time for each I2C adapter. If it needs to be accessed from multiple
    * places, the result of this call should be stored in a shared pointer and
    * copied around.
    * 
+   * The calibration coefficients of the sensor are read from its EEPROM with a
+   * single block read. If a calibration cache directory is given, they are
+   * stored there (in a file named after the I2C adapter and the address of the
+   * sensor) and the next instances read them from the file instead. If the
+   * sensor is replaced, the cache file must be deleted.
+   * 
    * @param mode
    *    The pressure sampling accuracy mode
    * @param sea_level_pressure
    *    The sea level pressure to use for altitude computation
+   * @param calibration_cache_dir
+   *    The directory for caching the calibration coefficients, or an empty
+   *    string for not using a cache
+   * @param i2c_adapter
+   *    The number N of the /dev/i2c-N adapter the device is connected to
    * @return
    *    The BMP180 instance
    * @throws ModuleAlreadyInUse
@@ -96,7 +110,9 @@ public:
    *    If the connected device is not a BMP180
    */
   static std::unique_ptr<BMP180> factory(PressureMode mode=PressureMode::STANDARD,
-                                         float sea_level_pressure=1020);
+                                         float sea_level_pressure=1020,
+                                         const std::string& calibration_cache_dir="",
+                                         int i2c_adapter=1);
   
   /// Allows other BMP180 instances to be created
   virtual ~BMP180();
@@ -156,21 +172,37 @@ public:
   /// given altitude
   float calibrateSeaLevelPressure(float altitude);
   
-  /// Start continuous measurement mode, which notifies the observers.
-  void start();
+  /**
+   * @brief Start continuous measurement mode, which notifies the observers
+   * 
+   * @details
+   * The measurements start at absolute deadlines, period_ms apart, so the
+   * conversion time of the pressure does not add to the period. With zero
+   * (the default) a new measurement starts as soon as the previous finishes.
+   * 
+   * @param period_ms
+   *    The time between the starts of two measurements (in milliseconds)
+   */
+  void start(unsigned int period_ms=0);
+  
+  /// Returns the statistics of the achieved period of the continuous
+  /// measurement mode, or null if it was never started
+  std::shared_ptr<PeriodStatistics> getStatistics() const;
   
   /// Stop the continuous measurement mode
   void stop();
   
 private:
   
-  BMP180(PressureMode mode, float sea_level_pressure);
+  BMP180(PressureMode mode, float sea_level_pressure, const std::string& calibration_cache_dir,
+         int i2c_adapter);
   
   std::int32_t computeB5(std::uint16_t ut);
   float computeRealTemperature(std::uint16_t ut, std::int32_t b5);
   float computeRealPressure(std::uint16_t ut, std::uint32_t up);
   float computeAltitude(float pressure);
   
+  std::shared_ptr<I2CBus> m_bus;
   PressureMode m_mode;
   float m_sea_level_pressure;
   std::int16_t m_ac1;
@@ -192,7 +224,7 @@ private:
   EncapsulatedObservable<float> m_pressure_observable;
   EncapsulatedObservable<float> m_altitude_observable;
   mutable std::mutex m_mutex;
-  std::atomic<bool> m_observing {false};
+  SamplingWorker m_worker;
   
 };
 
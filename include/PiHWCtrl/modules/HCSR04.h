@@ -25,11 +25,11 @@
 
 #include <memory>
 #include <mutex>
-#include <atomic>
 #include <PiHWCtrl/HWInterfaces/BinaryInput.h>
 #include <PiHWCtrl/HWInterfaces/Switch.h>
 #include <PiHWCtrl/HWInterfaces/AnalogInput.h>
 #include <PiHWCtrl/HWInterfaces/Observable.h>
+#include <PiHWCtrl/utils/SamplingWorker.h>
 
 namespace PiHWCtrl {
 
@@ -105,15 +105,20 @@ public:
    * 
    * @details
    * In this mode, the class will repeatedly use the sensor for measuring the
-   * distance and it will notify all the registered observers. The parameter
-   * is the idle time between performing two measurements and it can be used to
+   * distance and it will notify all the registered observers. The measurements
+   * start at absolute deadlines, period_ms apart, so the time of the
+   * measurement does not add to the period. The period must be long enough to
    * guarantee that a consequent measurement is not affected by reflections of
-   * a previous one.
+   * a previous one (the datasheet suggests at least 60 ms).
    * 
-   * @param sleep_ms
-   *    The idle time between measurements (in milliseconds)
+   * @param period_ms
+   *    The time between the starts of two measurements (in milliseconds)
    */
-  void start(unsigned int sleep_ms=60);
+  void start(unsigned int period_ms=60);
+  
+  /// Returns the statistics of the achieved period of the continuous
+  /// measurement mode, or null if it was never started
+  std::shared_ptr<PeriodStatistics> getStatistics() const;
   
   /// Stop the continuous measurement mode
   void stop();
@@ -125,7 +130,7 @@ private:
   float m_max_dist;
   float m_sound_speed;
   mutable std::mutex m_mutex;
-  std::atomic<bool> m_observing {false};
+  SamplingWorker m_worker;
   
 };
 
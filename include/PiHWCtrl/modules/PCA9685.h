@@ -30,6 +30,8 @@
 
 namespace PiHWCtrl {
 
+class I2CBus;
+
 /**
  * @class PCA9685
  * 
@@ -54,7 +56,8 @@ public:
    * allows for customization of the I2C address via 6 address pins, which can
    * be used to configure the address as the binary [1][A5][A4][A3][A2][A1][A0],
    * resulting to addresses in the range [0x40, 0x7F]. Only a single instance
-   * of the PCA9685 class per address can be instantiated at any time.
+   * of the PCA9685 class per address and I2C adapter can be instantiated at
+   * any time.
    * 
    * The second parameter is the frequency of the PWMs and is common to all 16
    * channels. It is expressed in Hz and it can get any value between 20 Hz and
@@ -64,10 +67,13 @@ public:
    *    The I2C address of the device
    * @param pwm_frequency
    *    The PWM frequency, expressed in Hz
+   * @param i2c_adapter
+   *    The number N of the /dev/i2c-N adapter the device is connected to
    * @return 
    *    The PCA9685 instance
    */
-  static std::unique_ptr<PCA9685> factory(std::uint8_t address, int pwm_frequency=200);
+  static std::unique_ptr<PCA9685> factory(std::uint8_t address, int pwm_frequency=200,
+                                          int i2c_adapter=1);
   
   /// Allows other PCA9685 instances to be created for the same address
   virtual ~PCA9685();
@@ -94,8 +100,9 @@ public:
   
 private:
   
-  PCA9685(std::uint8_t address, int pwm_frequency);
+  PCA9685(std::uint8_t address, int pwm_frequency, int i2c_adapter);
   
+  std::shared_ptr<I2CBus> m_bus;
   std::uint8_t m_address;
   mutable std::mutex m_mutex;
   
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file PiHWCtrl/pigpio/PigpioGpioBank.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_PIGPIOGPIOBANK_H
+#define PIHWCTRL_PIGPIOGPIOBANK_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <PiHWCtrl/HWInterfaces/ParallelOutput.h>
+#include <PiHWCtrl/HWInterfaces/ParallelInput.h>
+#include <PiHWCtrl/utils/GpioManager.h>
+#include <PiHWCtrl/pigpio/SmartPigpio.h>
+
+namespace PiHWCtrl {
+
+/**
+ * @class PigpioGpioBank
+ * 
+ * @brief
+ * Implementation of the ParallelOutput and ParallelInput interfaces using the
+ * pigpio library
+ * 
+ * @details
+ * This class controls a group of the GPIOs 2-28 of the 40 pin interface of the
+ * Raspberry Pi as a single word. The bit i of the word corresponds to the i-th
+ * GPIO given at the constructor. Writing a word costs the two pigpio calls
+ * gpioWrite_Bits_0_31_Set() and gpioWrite_Bits_0_31_Clear(), independently of
+ * the number of GPIOs, and reading it costs a single gpioRead_Bits_0_31().
+ * 
+ * The writes are not atomic. The bits to set are written first and the bits
+ * to clear after them, so for a short time the outputs show a mix of the old
+ * and the new word (the old ones plus the new set bits). If the bank drives a
+ * parallel bus which samples the lines asynchronously, latch the word with a
+ * separate strobe GPIO, or use the GpiocdevGpioBank, which gives all the
+ * values of a word to the kernel with a single request.
+ * 
+ * Any program using this class must be executed with root privileges (sudo).
+ */
+class PigpioGpioBank : public ParallelOutput, public ParallelInput {
+  
+public:
+  
+  enum class Mode {
+    INPUT, OUTPUT
+  };
+  
+  /**
+   * @brief Creates a PigpioGpioBank for the given GPIO pins
+   * 
+   * @details
+   * After the constructor has finished the mode of all the pins is set to the
+   * requested one. Banks in INPUT mode cannot use the write() method.
+   * 
+   * @param gpios
+   *    The GPIOs of the bank (maximum 32)
+   * @param mode
+   *    If the GPIOs are used as inputs or outputs
+   * 
+   * @throws GpioAlreadyResearved
+   *    If any of the GPIOs is already reserved by another PiHWCtrl object
+   * @throws BadGpioNumber
+   *    If any of the GPIOs is out of the range 2-28 or if the pigpio call
+   *    returns PI_BAD_GPIO
+   * @throws BadGpioMode
+   *    If the pigpio call returns PI_BAD_MODE
+   * @throws UnknownPigpioException
+   *    If the pigpio call returns any other error
+   */
+  PigpioGpioBank(const std::vector<int>& gpios, Mode mode=Mode::OUTPUT);
+  
+  /// Releases the GPIOs
+  virtual ~PigpioGpioBank() = default;
+  
+  /// Sets all the GPIOs to the bits of the given word (only for OUTPUT mode),
+  /// setting the bits before clearing them (see the class documentation)
+  void write(std::uint32_t word) override;
+  
+  /// Returns the states of all the GPIOs as the bits of a word
+  std::uint32_t read() const override;
+  
+private:
+  
+  std::vector<int> m_gpios;
+  Mode m_mode;
+  // We keep a pointer to the SmartPigpio singleton to guarantee that it is
+  // initialized and not deleted for the lifetime of the object
+  std::shared_ptr<SmartPigpio> m_smart_pigpio = SmartPigpio::getSingleton();
+  std::vector<std::unique_ptr<GpioManager::GpioReservation>> m_gpio_reservations;
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_PIGPIOGPIOBANK_H */
@@ -25,10 +25,14 @@
 
 #include <cstdint>
 #include <array>
+#include <vector>
+#include <mutex>
 #include <assert.h>
 #include <sys/ioctl.h> // For ioctl()
 #include <linux/spi/spidev.h>
 #include <PiHWCtrl/utils/GpioManager.h>
+#include <PiHWCtrl/spi/SPISegment.h>
+#include <PiHWCtrl/spi/SPITransaction.h>
 #include <PiHWCtrl/spi/exceptions.h>
 
 namespace PiHWCtrl {
@@ -37,8 +41,11 @@ class SPIBus {
   
 public:
   
+  /// The chip selects of the SPI controllers. The CE_N are the ones of the
+  /// main SPI (spidev0.N) and the AUX_CE_N the ones of the auxiliary SPI
+  /// (spidev1.N), which must be enabled with the spi1-3cs overlay.
   enum class Device {
-    CE_0, CE_1
+    CE_0, CE_1, AUX_CE_0, AUX_CE_1, AUX_CE_2
   };
   
   enum class Speed {
@@ -47,31 +54,115 @@ public:
     S_31_2_MHz, S_62_5_MHz, S_125_MHz
   };
   
-  SPIBus(Device device, Speed speed=Speed::S_488_kHz);
+  /// The SPI modes, defining the clock polarity (CPOL) and phase (CPHA)
+  enum class Mode {
+    MODE_0, ///< CPOL=0, CPHA=0
+    MODE_1, ///< CPOL=0, CPHA=1
+    MODE_2, ///< CPOL=1, CPHA=0
+    MODE_3  ///< CPOL=1, CPHA=1
+  };
+  
+  /**
+   * @brief Opens the spidev file of the given device
+   * 
+   * @details
+   * The speed and the bits per word are given with each transfer, so devices
+   * with different clock speeds share the controller without slowing each
+   * other down. The mode and the bit order are settings of the chip select.
+   * 
+   * @throws SPIBusOpenFailure
+   *    If the spidev file cannot be opened
+   * @throws SPIModeException, SPIBitsPerWordException, SPISpeedException
+   *    If the driver does not accept the settings
+   */
+  SPIBus(Device device, Speed speed=Speed::S_488_kHz, Mode mode=Mode::MODE_0,
+         std::uint8_t bits_per_word=8);
   
   virtual ~SPIBus();
   
+  /**
+   * @brief Starts a transaction with the SPI controller of the device
+   * 
+   * @details
+   * Each transfer locks the controller, so the devices sharing the SCLK, MOSI
+   * and MISO lines can be used from different threads. The transaction keeps
+   * the controller locked until it is destroyed, so a sequence of transfers
+   * (for example a command and its response) is not interleaved with the
+   * transfers of other threads.
+   */
+  SPITransaction startTransaction();
+  
+  /// The maximum number of segments of a single message, limited by the size
+  /// field of the SPI_IOC_MESSAGE ioctl number
+  static constexpr std::size_t MAX_SEGMENTS = 511;
+  
+  /**
+   * @brief Transfers the given number of bytes in full duplex
+   * 
+   * @details
+   * The buffers are passed directly to the kernel, without any intermediate
+   * copy. A null tx sends zeroes and a null rx discards the received bytes.
+   * Transfers longer than the getMaxTransferSize() are split in several
+   * messages, so the chip select is released between them.
+   * 
+   * @throws SPITransferException
+   *    If the transfer fails
+   */
+  void transfer(const std::uint8_t* tx, std::uint8_t* rx, std::size_t size);
+  
+  /**
+   * @brief Transfers the given segments as a single message, with a single
+   * SPI_IOC_MESSAGE ioctl
+   * 
+   * @details
+   * The chip select stays selected between the segments, unless a segment sets
+   * its cs_change flag.
+   * 
+   * @throws SPITooManySegments
+   *    If there are more than MAX_SEGMENTS segments
+   * @throws SPIMessageTooLong
+   *    If the total size of the segments is bigger than getMaxTransferSize()
+   * @throws SPITransferException
+   *    If the transfer fails
+   */
+  void transfer(const SPISegment* segments, std::size_t count);
+  
+  /// Sets the SPI mode of the device
+  void setMode(Mode mode);
+  
+  /// Sets if the bits of each word are sent with the least significant first.
+  /// The auxiliary SPI does not support it.
+  void setLsbFirst(bool lsb_first);
+  
+  /// Sets the size of the words (8 by default)
+  void setBitsPerWord(std::uint8_t bits_per_word);
+  
+  /// Sets the clock speed of the transfers of this instance
+  void setSpeed(Speed speed);
+  
+  /// Sets the clock speed of the transfers of this instance, in Hz. The
+  /// controller uses the closest speed it supports which is not higher.
+  void setSpeedHz(std::uint32_t speed_hz);
+  
+  /// Sets the delay after each transfer, before changing the chip select
+  void setDelay(std::uint16_t delay_usecs);
+  
+  Mode getMode() const;
+  
+  bool isLsbFirst() const;
+  
+  std::uint8_t getBitsPerWord() const;
+  
+  std::uint32_t getSpeedHz() const;
+  
+  /// Returns the maximum number of bytes of a single message, which is the
+  /// buffer size of the spidev driver (its bufsiz module parameter)
+  std::size_t getMaxTransferSize() const;
+  
   template <std::size_t Size>
   std::array<std::uint8_t, Size> transferArray(const std::array<std::uint8_t, Size>& tx) {
-    
     std::array<std::uint8_t, Size> rx;
-    
-    spi_ioc_transfer tr;
-    tr.tx_buf = std::uint64_t(tx.data());
-    tr.rx_buf = std::uint64_t(rx.data());
-    tr.len = Size;
-    tr.delay_usecs = m_delay_usecs;
-    tr.speed_hz = m_speed_hz;
-    tr.bits_per_word = m_bits_per_word;
-    tr.cs_change = 0;
-    tr.tx_nbits=0;
-    tr.rx_nbits=0;
-    tr.pad=0;
-
-    if (ioctl(m_bus_file, SPI_IOC_MESSAGE(1), &tr) != Size) {
-      throw SPITransferException();
-    }
-    
+    transfer(tx.data(), rx.data(), Size);
     return rx;
   }
   
@@ -80,23 +171,10 @@ public:
     static_assert(sizeof(Response) == sizeof(Transmit),
             "SPI transfer Response and Transmit types must have the same size");
     
-    // Construct the array to send to the bus
-    std::array<std::uint8_t, sizeof(Transmit)> tx;
-    const std::uint8_t* value_ptr = reinterpret_cast<const std::uint8_t*>(&value);
-    for (int i = 0; i < sizeof(Transmit); ++i) {
-      tx[i] = *(value_ptr + i);
-    }
-    
-    // Transmit the value and get the response as an array
-    auto rx = transferArray(tx);
-    
-    // Convert the response to the correct type
+    // Transfer directly from the value to the response
     Response result;
-    std::uint8_t* result_ptr = reinterpret_cast<std::uint8_t*>(&result);
-    for (int i = 0; i < sizeof(Response); ++i) {
-      *(result_ptr + i) = rx[i];
-    }
-    
+    transfer(reinterpret_cast<const std::uint8_t*>(&value),
+             reinterpret_cast<std::uint8_t*>(&result), sizeof(Transmit));
     return result;
   }
   
@@ -108,14 +186,10 @@ public:
   
   template <typename T>
   T read() {
-    // Create an array of zeroes to send
-    std::array<std::uint8_t, sizeof(T)> tx;
-    for (auto& x : tx) {
-      x = 0;
-    }
-    
-    // Transmit the dummy array and return the result
-    return transfer<T>(tx);
+    // Transmit zeroes and return the result
+    T result;
+    transfer(nullptr, reinterpret_cast<std::uint8_t*>(&result), sizeof(T));
+    return result;
   }
   
 private:
@@ -123,9 +197,26 @@ private:
   std::unique_ptr<GpioManager::GpioReservation> m_ce_gpio_reservation;
   Device m_device;
   int m_bus_file;
+  Mode m_mode;
+  bool m_lsb_first;
   std::uint16_t m_delay_usecs;
   std::uint32_t m_speed_hz;
   std::uint8_t m_bits_per_word;
+  std::size_t m_max_transfer_size;
+  // The lock of the controller of the device, shared by all its devices
+  std::recursive_mutex* m_controller_mutex;
+  // The settings last applied to the spidev file, so the setters skip the
+  // ioctls which would not change anything (-1 or 0 if not known). The mode
+  // and the bit order are bits of the same word of the driver, so writing the
+  // mode invalidates the cached bit order.
+  struct AppliedSettings {
+    int mode = -1;
+    int lsb_first = -1;
+    int bits_per_word = -1;
+    std::uint32_t speed_hz = 0;
+  } m_applied;
+  // Reused by the transfers, so they do not allocate memory
+  std::vector<spi_ioc_transfer> m_transfers;
   
 };
 
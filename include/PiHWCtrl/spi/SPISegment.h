@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file spi/SPISegment.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_SPISEGMENT_H
+#define PIHWCTRL_SPISEGMENT_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace PiHWCtrl {
+
+/**
+ * @struct SPISegment
+ * 
+ * @brief
+ * A part of an SPI message, which is sent with a single SPI_IOC_MESSAGE ioctl
+ * together with the rest of the segments (see SPIBus::transfer())
+ * 
+ * @details
+ * The buffers are used directly by the kernel, without any copy. A null tx
+ * buffer sends zeroes and a null rx buffer discards the received bytes.
+ */
+struct SPISegment {
+  /// The bytes to send, or null for sending zeroes
+  const std::uint8_t* tx;
+  /// The buffer for the received bytes, or null for ignoring them
+  std::uint8_t* rx;
+  /// The number of bytes of the segment
+  std::size_t size;
+  /// If true the chip select is released after the segment (or kept selected
+  /// if it is the last one of the message)
+  bool cs_change;
+  /// The time to wait after the segment, before changing the chip select
+  std::uint16_t delay_usecs;
+  /// The clock speed of the segment in Hz, or zero for the speed of the bus
+  std::uint32_t speed_hz;
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_SPISEGMENT_H */
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file spi/SPIStreamWriter.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_SPISTREAMWRITER_H
+#define PIHWCTRL_SPISTREAMWRITER_H
+
+#include <cstdint>
+#include <cstdlib> // for std::free
+#include <memory>
+#include <array>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <PiHWCtrl/spi/SPIBus.h>
+
+namespace PiHWCtrl {
+
+/**
+ * @class SPIStreamWriter
+ * 
+ * @brief
+ * Writes long streams of data to an SPI device, keeping the bus continuously
+ * busy
+ * 
+ * @details
+ * The data are collected in two page aligned buffers of the size of the
+ * spidev buffer (see SPIBus::getMaxTransferSize()), which are allocated once.
+ * When a buffer is full it is sent by the thread of the writer, while the
+ * other buffer is filled with the next chunk. The chip select is released
+ * between the chunks, which the LED strips and most displays accept.
+ * 
+ * Each chunk is a separate transfer, so the transfers of other threads to the
+ * devices of the same controller are done between the chunks. For reading long
+ * streams use the SPIBus::transfer() with a null tx buffer, which receives
+ * directly in the buffer of the caller.
+ * 
+ * The writer must not be used by a thread holding an SPITransaction of the
+ * same controller. The thread of the writer needs the controller lock for each
+ * chunk, while the caller waits for it in the flush() (or in the write() and
+ * the generate() when both buffers are full), so both would block forever.
+ * Finish the transaction before writing to the stream.
+ */
+class SPIStreamWriter {
+  
+public:
+  
+  /// Called with a part of a buffer of the writer to fill it with the next
+  /// bytes of the stream
+  using Producer = std::function<void(std::uint8_t* buffer, std::size_t size)>;
+  
+  /**
+   * @brief Creates a writer for the given bus
+   * 
+   * @param bus
+   *    The bus to write to, which must outlive the writer
+   * @param chunk_size
+   *    The bytes sent with each transfer. Zero (the default) uses the maximum
+   *    the driver allows.
+   * @throws SPIMessageTooLong
+   *    If the chunk_size is bigger than the SPIBus::getMaxTransferSize()
+   */
+  explicit SPIStreamWriter(SPIBus& bus, std::size_t chunk_size=0);
+  
+  /// Sends the remaining data and stops the thread of the writer. The errors
+  /// of the last transfers are ignored (call flush() to get them). Like the
+  /// flush(), it must not be called while holding an SPITransaction.
+  virtual ~SPIStreamWriter();
+  
+  /**
+   * @brief Appends the given data to the stream
+   * 
+   * @details
+   * It blocks only when both buffers are full, until the first of them is
+   * sent, so it must not be called while holding an SPITransaction.
+   * 
+   * @throws SPITransferException
+   *    If a previous transfer failed
+   */
+  void write(const std::uint8_t* data, std::size_t size);
+  
+  /**
+   * @brief Appends the given number of bytes to the stream, generated by the
+   * producer directly in the buffers of the writer
+   * 
+   * @details
+   * This avoids copying data which are computed anyway, like the encoding of
+   * the colors of an LED strip. The producer is called with consecutive parts
+   * of the buffers until it has generated all the bytes. Like the write(), it
+   * must not be called while holding an SPITransaction.
+   * 
+   * @throws SPITransferException
+   *    If a previous transfer failed
+   */
+  void generate(std::size_t size, Producer producer);
+  
+  /**
+   * @brief Sends the data written so far and waits until they are transferred
+   * 
+   * @details
+   * It must not be called while holding an SPITransaction of the controller,
+   * because the thread of the writer could never do the transfers.
+   * 
+   * @throws SPITransferException
+   *    If any transfer failed
+   */
+  void flush();
+  
+  /// Returns the number of bytes of each transfer
+  std::size_t getChunkSize() const;
+  
+private:
+  
+  static constexpr int BUFFERS = 2;
+  
+  struct FreeDeleter {
+    void operator()(std::uint8_t* ptr) const {
+      std::free(ptr);
+    }
+  };
+  
+  struct Buffer {
+    std::unique_ptr<std::uint8_t, FreeDeleter> data;
+    std::size_t size;
+    // True while the buffer waits to be sent or it is being sent
+    bool busy;
+  };
+  
+  // Returns the free space of the current buffer, sending it and waiting for
+  // the next one if it is full
+  std::size_t nextSpace();
+  
+  // Hands the current buffer to the thread of the writer and waits until the
+  // next one is free. The mutex must be locked.
+  void submitCurrent(std::unique_lock<std::mutex>& lock);
+  
+  // Rethrows the error of a failed transfer. The mutex must be locked.
+  void checkError();
+  
+  void sendLoop();
+  
+  SPIBus& m_bus;
+  std::size_t m_chunk_size;
+  std::array<Buffer, BUFFERS> m_buffers;
+  int m_current = 0;
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  // The indices of the buffers to send, in order
+  std::deque<int> m_queue;
+  std::exception_ptr m_error;
+  bool m_stopping = false;
+  std::thread m_thread;
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_SPISTREAMWRITER_H */
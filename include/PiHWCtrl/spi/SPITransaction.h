@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file spi/SPITransaction.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_SPITRANSACTION_H
+#define PIHWCTRL_SPITRANSACTION_H
+
+#include <mutex>
+
+namespace PiHWCtrl {
+
+/**
+ * @class SPITransaction
+ * 
+ * @brief
+ * Gives to a thread the exclusive use of an SPI controller, for a sequence of
+ * transfers which must not be interleaved with the transfers to other devices
+ * 
+ * @details
+ * The single transfers of the SPIBus are already serialized, so a transaction
+ * is needed only for keeping a sequence of them together. The lock is
+ * recursive, so the thread of the transaction can keep using the SPIBus
+ * methods, and start transactions with all the devices of the same controller.
+ * Get it with the SPIBus::startTransaction().
+ */
+class SPITransaction {
+  
+public:
+  
+  /// Blocks until the controller lock is given to the transaction
+  SPITransaction(std::recursive_mutex& controller_mutex) : m_lock(controller_mutex) {
+  }
+  
+  SPITransaction(SPITransaction&& other) = default;
+  SPITransaction& operator=(SPITransaction&& other) = default;
+  
+  virtual ~SPITransaction() = default;
+  
+private:
+  
+  std::unique_lock<std::recursive_mutex> m_lock;
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_SPITRANSACTION_H */
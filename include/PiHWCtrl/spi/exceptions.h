@@ -76,6 +76,17 @@ public:
   int err_code;
 };
 
+class SPILsbFirstException : public Exception {
+public:
+  SPILsbFirstException(bool lsb_first) : lsb_first(lsb_first), err_code(errno) {
+    appendMessage("Failed to set the SPI bus bit order to ");
+    appendMessage(lsb_first ? "LSB first: " : "MSB first: ");
+    appendMessage(std::strerror(err_code));
+  }
+  bool lsb_first;
+  int err_code;
+};
+
 class SPITransferException : public Exception {
 public:
   SPITransferException() : err_code(errno) {
@@ -85,6 +96,31 @@ public:
   int err_code;
 };
 
+class SPIMessageTooLong : public Exception {
+public:
+  SPIMessageTooLong(std::size_t size, std::size_t max_size) : size(size), max_size(max_size) {
+    appendMessage("SPI message of ");
+    appendMessage(size);
+    appendMessage(" bytes is longer than the spidev buffer (");
+    appendMessage(max_size);
+    appendMessage(" bytes)");
+  }
+  std::size_t size;
+  std::size_t max_size;
+};
+
+class SPITooManySegments : public Exception {
+public:
+  SPITooManySegments(std::size_t count, std::size_t max_count) : count(count), max_count(max_count) {
+    appendMessage("SPI message of ");
+    appendMessage(count);
+    appendMessage(" segments exceeds the maximum of ");
+    appendMessage(max_count);
+  }
+  std::size_t count;
+  std::size_t max_count;
+};
+
 } // end of namespace PiHWCtrl
 
 #endif /* PIHWCTRL_SPI_EXCEPTIONS_H */
@@ -25,6 +25,8 @@
 
 #include <array>
 #include <memory>
+#include <atomic>
+#include <functional> // for std::reference_wrapper
 
 namespace PiHWCtrl {
 
@@ -42,9 +44,10 @@ public:
   
 private:
   
-  GpioManager() = default;
+  GpioManager();
   
-  std::array<bool, 29> m_reserved_flags;
+  // Atomic, so GPIOs can be reserved and released from different threads
+  std::array<std::atomic<bool>, 29> m_reserved_flags;
   
 };
 
@@ -52,7 +55,7 @@ class GpioManager::GpioReservation {
   
 public:
 
-  GpioReservation(bool& flag) : m_flag(flag) { }
+  GpioReservation(std::atomic<bool>& flag) : m_flag(flag) { }
 
   // We do not want to allow to copy or move the reservation. Its lifetime should
   // be controlled by the unique_ptr returned by the reserveGpio().
@@ -62,12 +65,12 @@ public:
   GpioReservation& operator=(GpioReservation&&) = delete;
 
   ~GpioReservation() {
-    m_flag.get() = false;
+    m_flag.get().store(false);
   }
 
 private:
 
-  std::reference_wrapper<bool> m_flag;
+  std::reference_wrapper<std::atomic<bool>> m_flag;
 
 };
 
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file PiHWCtrl/utils/LatencyHistogram.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_UTILS_LATENCYHISTOGRAM_H
+#define PIHWCTRL_UTILS_LATENCYHISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <chrono>
+
+namespace PiHWCtrl {
+
+/**
+ * @class LatencyHistogram
+ * 
+ * @brief
+ * Histogram of latencies with logarithmic bins
+ * 
+ * @details
+ * The bin 0 counts the latencies smaller than 1us and the bin i counts the
+ * latencies in the range [2^(i-1), 2^i) us. The last bin counts all the
+ * latencies which do not fit in the previous ones. Recording a latency is lock
+ * free, so it can be done from time critical code while other threads read the
+ * histogram.
+ */
+class LatencyHistogram {
+  
+public:
+  
+  static constexpr std::size_t BINS = 32;
+  
+  struct Snapshot {
+    /// The number of recorded latencies
+    std::uint64_t count;
+    /// The maximum recorded latency
+    std::chrono::nanoseconds max;
+    /// The number of latencies in each bin
+    std::array<std::uint64_t, BINS> bins;
+    /// Returns the upper limit of the bin which contains the given fraction
+    /// (in the range [0,1]) of the latencies
+    std::chrono::nanoseconds percentile(double fraction) const;
+  };
+  
+  LatencyHistogram();
+  
+  virtual ~LatencyHistogram() = default;
+  
+  /// Records a latency
+  void record(std::chrono::nanoseconds latency);
+  
+  /// Returns the histogram collected so far
+  Snapshot getSnapshot() const;
+  
+  /// Returns the upper limit of the given bin
+  static std::chrono::nanoseconds binUpperLimit(std::size_t bin);
+  
+  /// Returns the upper limit of the bin which contains the given fraction
+  /// (in the range [0,1]) of the recorded latencies
+  std::chrono::nanoseconds percentile(double fraction) const;
+  
+  /// Clears all the recorded latencies
+  void reset();
+  
+private:
+  
+  std::array<std::atomic<std::uint64_t>, BINS> m_bins;
+  std::atomic<std::uint64_t> m_count {0};
+  std::atomic<std::int64_t> m_max {0};
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_UTILS_LATENCYHISTOGRAM_H */
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file PiHWCtrl/utils/PeriodStatistics.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_UTILS_PERIODSTATISTICS_H
+#define PIHWCTRL_UTILS_PERIODSTATISTICS_H
+
+#include <cstddef>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace PiHWCtrl {
+
+/**
+ * @class PeriodStatistics
+ * 
+ * @brief
+ * Collects statistics about how close a periodic task is to its nominal period
+ * 
+ * @details
+ * The task calls recordExecution() every time it runs and recordOverrun() when
+ * it misses deadlines. The jitter is the difference between the time between
+ * two consecutive executions and the nominal period. The 99th percentile is
+ * computed from the most recent executions only. The class is thread safe, so
+ * the statistics can be retrieved while the task is running.
+ */
+class PeriodStatistics {
+  
+public:
+  
+  using Clock = std::chrono::steady_clock;
+  
+  struct Snapshot {
+    /// The number of executions
+    std::size_t executions;
+    /// The number of missed deadlines
+    std::size_t overruns;
+    /// The achieved executions per second
+    double rate;
+    /// The minimum (most negative) jitter
+    std::chrono::nanoseconds min_jitter;
+    /// The maximum jitter
+    std::chrono::nanoseconds max_jitter;
+    /// The 99th percentile of the absolute jitter
+    std::chrono::nanoseconds p99_jitter;
+  };
+  
+  /**
+   * @brief Creates a PeriodStatistics object
+   * 
+   * @param period
+   *    The nominal period of the task
+   * @param history
+   *    The number of most recent executions used for the percentile
+   */
+  PeriodStatistics(std::chrono::nanoseconds period, std::size_t history=1000);
+  
+  virtual ~PeriodStatistics() = default;
+  
+  /// Records that the task was executed at the given time
+  void recordExecution(Clock::time_point time);
+  
+  /// Records that the task missed the given number of deadlines
+  void recordOverrun(std::size_t missed=1);
+  
+  /// Returns the statistics collected so far
+  Snapshot getSnapshot() const;
+  
+  /// Clears all the collected statistics
+  void reset();
+  
+private:
+  
+  std::chrono::nanoseconds m_period;
+  std::size_t m_history;
+  mutable std::mutex m_mutex;
+  std::size_t m_executions {0};
+  std::size_t m_overruns {0};
+  Clock::time_point m_first;
+  Clock::time_point m_last;
+  std::chrono::nanoseconds m_min_jitter {0};
+  std::chrono::nanoseconds m_max_jitter {0};
+  // Ring buffer with the absolute jitter of the most recent executions
+  std::vector<std::chrono::nanoseconds> m_recent;
+  std::size_t m_recent_next {0};
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_UTILS_PERIODSTATISTICS_H */
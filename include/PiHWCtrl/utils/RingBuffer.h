@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file PiHWCtrl/utils/RingBuffer.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_UTILS_RINGBUFFER_H
+#define PIHWCTRL_UTILS_RINGBUFFER_H
+
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <PiHWCtrl/HWInterfaces/exceptions.h>
+
+namespace PiHWCtrl {
+
+/**
+ * @class RingBuffer
+ * 
+ * @brief Bounded lock-free queue
+ * 
+ * @details
+ * The queue is a ring of cells, each one with a sequence number telling if it
+ * is free to be written or ready to be read (the bounded queue of D. Vyukov).
+ * Pushing and popping never block and they are safe from any number of threads,
+ * so a producer can also pop elements, for example to drop the oldest ones
+ * when the queue is full.
+ * 
+ * @tparam T
+ *    The type of the elements. It must be default constructible and movable.
+ */
+template <typename T>
+class RingBuffer {
+  
+public:
+  
+  /// Creates a queue which can keep the given number of elements (rounded up
+  /// to the next power of two)
+  RingBuffer(std::size_t capacity) {
+    if (capacity == 0) {
+      throw Exception() << "RingBuffer capacity must be positive";
+    }
+    m_capacity = 1;
+    while (m_capacity < capacity) {
+      m_capacity <<= 1;
+    }
+    m_mask = m_capacity - 1;
+    m_cells.reset(new Cell[m_capacity]);
+    for (std::size_t i = 0; i < m_capacity; ++i) {
+      m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+  
+  RingBuffer(const RingBuffer&) = delete;
+  RingBuffer& operator=(const RingBuffer&) = delete;
+  
+  /// Adds an element at the end of the queue. Returns false if the queue is
+  /// full.
+  bool tryPush(T value) {
+    std::size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &m_cells[pos & m_mask];
+      std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+      if (diff == 0) {
+        if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = m_enqueue_pos.load(std::memory_order_relaxed);
+      }
+    }
+    cell->value = std::move(value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+  
+  /// Removes the first element of the queue. Returns false if the queue is
+  /// empty.
+  bool tryPop(T& value) {
+    std::size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &m_cells[pos & m_mask];
+      std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+      if (diff == 0) {
+        if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = m_dequeue_pos.load(std::memory_order_relaxed);
+      }
+    }
+    value = std::move(cell->value);
+    cell->sequence.store(pos + m_capacity, std::memory_order_release);
+    return true;
+  }
+  
+  /// Returns the number of elements in the queue. When other threads modify
+  /// the queue the result is only an approximation.
+  std::size_t size() const {
+    std::size_t dequeue = m_dequeue_pos.load();
+    std::size_t enqueue = m_enqueue_pos.load();
+    return (enqueue > dequeue) ? enqueue - dequeue : 0;
+  }
+  
+  /// Returns the maximum number of elements the queue can keep
+  std::size_t capacity() const {
+    return m_capacity;
+  }
+  
+private:
+  
+  struct Cell {
+    std::atomic<std::size_t> sequence;
+    T value;
+  };
+  
+  std::size_t m_capacity;
+  std::size_t m_mask;
+  std::unique_ptr<Cell[]> m_cells;
+  // The positions are modified by different threads, so we keep them in
+  // different cache lines
+  alignas(64) std::atomic<std::size_t> m_enqueue_pos {0};
+  alignas(64) std::atomic<std::size_t> m_dequeue_pos {0};
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_UTILS_RINGBUFFER_H */
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file PiHWCtrl/utils/SamplingScheduler.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_UTILS_SAMPLINGSCHEDULER_H
+#define PIHWCTRL_UTILS_SAMPLINGSCHEDULER_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <queue>
+#include <map>
+#include <PiHWCtrl/utils/PeriodStatistics.h>
+
+namespace PiHWCtrl {
+
+/**
+ * @class SamplingScheduler
+ * 
+ * @brief
+ * Executes periodic sampling jobs using a single timer thread and a small pool
+ * of worker threads
+ * 
+ * @details
+ * The timer thread keeps the deadlines of all the jobs in a min-heap and sleeps
+ * until the earliest one. When a deadline is reached the job is handed to one
+ * of the workers. The deadlines are absolute (the first one is the time the
+ * job was scheduled and each next one is one period later), so the execution
+ * time of a job does not make it drift. A job is never executed in parallel
+ * with itself: if it is still running when its next deadline is reached, that
+ * execution is skipped and counted as an overrun in the statistics of the job.
+ * 
+ * The jobs should not block for long, because they occupy one of the workers
+ * while running. Sources which block (for example waiting for interrupts)
+ * should use a SamplingWorker instead.
+ */
+class SamplingScheduler {
+  
+public:
+  
+  using Job = std::function<void()>;
+  using JobId = std::uint64_t;
+  
+  /// Returns the scheduler shared by all the PiHWCtrl classes
+  static std::shared_ptr<SamplingScheduler> getSingleton();
+  
+  /// Creates a scheduler with the given number of worker threads
+  SamplingScheduler(unsigned int workers=2);
+  
+  SamplingScheduler(const SamplingScheduler&) = delete;
+  SamplingScheduler& operator=(const SamplingScheduler&) = delete;
+  
+  /// Stops all the threads. Jobs which are running are finished first.
+  virtual ~SamplingScheduler();
+  
+  /**
+   * @brief Schedules a job to be executed periodically
+   * 
+   * @details
+   * The first execution happens immediately.
+   * 
+   * @param job
+   *    The function to execute
+   * @param period
+   *    The time between two executions (must be positive)
+   * @return
+   *    The identifier to use for cancelling the job
+   * 
+   * @throws Exception
+   *    If the period is not positive
+   */
+  JobId schedule(Job job, std::chrono::nanoseconds period);
+  
+  /**
+   * @brief Cancels a scheduled job
+   * 
+   * @details
+   * If the job is running at the moment, the call waits until it has finished,
+   * so after it returns the job will not be executed any more. The only
+   * exception is when a job cancels itself. Cancelling a job which is not
+   * scheduled does nothing.
+   */
+  void cancel(JobId id);
+  
+  /// Returns the period statistics of a scheduled job, or nullptr if the job
+  /// is not scheduled
+  std::shared_ptr<PeriodStatistics> getStatistics(JobId id);
+  
+private:
+  
+  using Clock = std::chrono::steady_clock;
+  
+  struct JobState {
+    Job job;
+    std::chrono::nanoseconds period;
+    bool running;
+    std::shared_ptr<PeriodStatistics> statistics;
+  };
+  
+  struct Deadline {
+    Clock::time_point time;
+    JobId id;
+    bool operator>(const Deadline& other) const {
+      return time > other.time;
+    }
+  };
+  
+  void timerLoop();
+  void workerLoop();
+  
+  std::mutex m_mutex;
+  std::condition_variable m_timer_condition;
+  std::condition_variable m_worker_condition;
+  std::condition_variable m_done_condition;
+  bool m_stopping {false};
+  JobId m_next_id {1};
+  std::map<JobId, std::shared_ptr<JobState>> m_jobs;
+  std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> m_deadlines;
+  std::deque<std::shared_ptr<JobState>> m_ready;
+  std::thread m_timer_thread;
+  std::vector<std::thread> m_worker_threads;
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_UTILS_SAMPLINGSCHEDULER_H */
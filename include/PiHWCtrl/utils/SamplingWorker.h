@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file PiHWCtrl/utils/SamplingWorker.h
+ * @author nikoapos
+ */
+
+#ifndef PIHWCTRL_UTILS_SAMPLINGWORKER_H
+#define PIHWCTRL_UTILS_SAMPLINGWORKER_H
+
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <PiHWCtrl/utils/PeriodStatistics.h>
+
+namespace PiHWCtrl {
+
+/// What a SamplingWorker does when the task takes longer than the period and
+/// the next deadline has already passed
+enum class OverrunPolicy {
+  /// Execute the late iterations immediately, one after the other, until the
+  /// worker is back on schedule (no iterations are lost)
+  CATCH_UP,
+  /// Drop the missed deadlines and continue from the next one in the future
+  SKIP
+};
+
+/**
+ * @class SamplingWorker
+ * 
+ * @brief
+ * Owns a thread which repeatedly executes a sampling task until it is stopped
+ * 
+ * @details
+ * The thread executes the task at absolute deadlines, one period apart, so the
+ * time spent by the task does not add to the period and the sampling does not
+ * drift. When the task takes longer than the period the OverrunPolicy decides
+ * if the late iterations are executed immediately or skipped. The achieved
+ * period is recorded in a PeriodStatistics (see getStatistics()).
+ * 
+ * The sleeping is done on a condition variable, so the stop() wakes up the thread
+ * immediately and then joins it. This means that stop() returns as soon as the
+ * current execution of the task has finished, without spending any CPU time
+ * while waiting. Tasks which take long (like performing several measurements)
+ * can use the sleepFor() and stopRequested() methods to return earlier.
+ * 
+ * Tasks which block in a system call (like waiting for an interrupt) can be
+ * given a wakeup function, which is called by the stop() to unblock them.
+ */
+class SamplingWorker {
+  
+public:
+  
+  using Task = std::function<void()>;
+  using WakeupFunction = std::function<void()>;
+  
+  SamplingWorker() = default;
+  
+  SamplingWorker(const SamplingWorker&) = delete;
+  SamplingWorker& operator=(const SamplingWorker&) = delete;
+  
+  /// Stops the thread, if it is still running
+  virtual ~SamplingWorker();
+  
+  /**
+   * @brief Starts the thread executing the given task
+   * 
+   * @param task
+   *    The function to execute repeatedly
+   * @param period
+   *    The time between the starts of two executions of the task. With zero
+   *    the task is executed again as soon as it returns.
+   * @param wakeup
+   *    Optional function called by the stop() for unblocking the task
+   * @param policy
+   *    What to do when the task misses its next deadline
+   * 
+   * @throws Exception
+   *    If the worker is already started
+   */
+  void start(Task task, std::chrono::nanoseconds period=std::chrono::nanoseconds{0},
+             WakeupFunction wakeup=nullptr, OverrunPolicy policy=OverrunPolicy::SKIP);
+  
+  /**
+   * @brief Stops the thread and waits until it has finished
+   * 
+   * @details
+   * If the worker is not started the call does nothing.
+   * 
+   * @throws Exception
+   *    If it is called from the task itself
+   */
+  void stop();
+  
+  /// Returns true if the thread of the worker is running
+  bool isRunning() const;
+  
+  /// Returns the statistics of the period of the last start(), which are
+  /// updated while the worker runs, or null if it was never started
+  std::shared_ptr<PeriodStatistics> getStatistics() const;
+  
+  /// Returns true if the stop() has been called. To be used by the task.
+  bool stopRequested() const;
+  
+  /// Sleeps for the given duration or until the stop() is called. Returns
+  /// false if the sleep was interrupted. To be used by the task.
+  bool sleepFor(std::chrono::nanoseconds duration);
+  
+private:
+  
+  // Sleeps until the given time or until the stop() is called. Returns false
+  // if the sleep was interrupted.
+  bool sleepUntil(PeriodStatistics::Clock::time_point time);
+  
+  std::thread m_thread;
+  // Serializes the start() and stop() calls
+  mutable std::mutex m_control_mutex;
+  // Protects the stop flag for the condition variable
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::atomic<bool> m_stop_requested {false};
+  WakeupFunction m_wakeup;
+  std::shared_ptr<PeriodStatistics> m_statistics;
+  
+};
+
+} // end of namespace PiHWCtrl
+
+#endif /* PIHWCTRL_UTILS_SAMPLINGWORKER_H */
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file benchmarks/ADS1115ContinuousBenchmark.cpp
+ * @author nikoapos
+ */
+
+/*
+ * Description
+ * -----------
+ * 
+ * Benchmark comparing the conversions per second of the ADS1115 at 860 SPS:
+ * 
+ * - In single shot mode, with a loop calling the readConversion(), which
+ *   sleeps for the conversion time and polls the config register
+ * - In the native continuous mode, with the startContinuous(), which reads
+ *   each conversion when the ALERT/RDY pin signals it is ready
+ * 
+ * It runs on a simulated 400 kHz I2C bus, so it does not need any hardware.
+ * The ALERT/RDY pin is simulated by a thread generating a ready event every
+ * 1/860 seconds, like a GPIO input notifying only the rising edges. It also prints the config register of the simulated device in
+ * continuous mode and after the stop(), to show that the comparator is used
+ * as a conversion ready signal and that the device returns to single shot.
+ * 
+ * Execution:
+ * Run the benchmark, optionally giving the duration of each measurement in
+ * milliseconds as argument (default 1000).
+ */
+
+#include <iostream> // for std::cout
+#include <iomanip>  // for std::hex
+#include <chrono>   // for std::chrono::milliseconds
+#include <string>   // for std::stoul
+#include <memory>   // for std::make_shared
+#include <atomic>
+#include <thread>
+#include <PiHWCtrl/HWInterfaces/Observer.h>
+#include <PiHWCtrl/utils/EncapsulatedObservable.h>
+#include <PiHWCtrl/i2c/I2CBus.h>
+#include <PiHWCtrl/i2c/SimulatedI2CTransport.h>
+#include <PiHWCtrl/i2c/SimulatedI2CDevices.h>
+#include <PiHWCtrl/modules/ADS1115.h>
+
+namespace {
+
+// The simulated bus uses an adapter number which does not exist on the Pi
+constexpr int ADAPTER = 100;
+
+constexpr int DATA_RATE = 860;
+
+using Input = PiHWCtrl::ADS1115::Input;
+
+class CountingObserver : public PiHWCtrl::Observer<float> {
+public:
+  void event(const float& value) override {
+    last = value;
+    ++count;
+  }
+  std::atomic<long> count {0};
+  std::atomic<float> last {0};
+};
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[]) {
+  
+  std::chrono::milliseconds duration {(argc > 1) ? std::stoul(argv[1]) : 1000};
+  
+  auto adc = std::make_shared<PiHWCtrl::SimulatedADS1115>();
+  adc->setInputVoltage(0, 1.234);
+  auto transport = std::make_unique<PiHWCtrl::SimulatedI2CTransport>(
+                                      PiHWCtrl::SimulatedI2CTransport::FAST_MODE);
+  transport->addDevice(0x48, adc);
+  auto bus = PiHWCtrl::I2CBus::attach(ADAPTER, std::move(transport));
+  auto ads1115 = PiHWCtrl::ADS1115::factory(PiHWCtrl::ADS1115::AddressPin::GND,
+                                            PiHWCtrl::ADS1115::DataRate::DR_860_SPS, ADAPTER);
+  
+  // Single shot mode
+  long single_shot_count = 0;
+  auto start = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() - start < duration) {
+    ads1115->readConversion(Input::AIN0_GND);
+    ++single_shot_count;
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << "Single shot: " << static_cast<long>(single_shot_count / elapsed.count())
+            << " conversions/s\n";
+  
+  // Continuous mode, with the simulated ALERT/RDY pin
+  auto observer = std::make_shared<CountingObserver>();
+  ads1115->addConversionObserver(Input::AIN0_GND, observer);
+  PiHWCtrl::EncapsulatedObservable<bool> alert_rdy;
+  ads1115->startContinuous(Input::AIN0_GND, alert_rdy);
+  std::cout << "Config in continuous mode: 0x" << std::hex << adc->getConfig() << std::dec << "\n";
+  
+  std::atomic<bool> running {true};
+  std::thread rdy_thread {[&]() {
+    auto next = std::chrono::steady_clock::now();
+    while (running) {
+      next += std::chrono::nanoseconds(1000000000 / DATA_RATE);
+      std::this_thread::sleep_until(next);
+      alert_rdy.createEvent(true);
+    }
+  }};
+  start = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(duration);
+  elapsed = std::chrono::steady_clock::now() - start;
+  long continuous_count = observer->count;
+  running = false;
+  rdy_thread.join();
+  std::cout << "Continuous:  " << static_cast<long>(continuous_count / elapsed.count())
+            << " conversions/s (last " << observer->last << "V)\n";
+  
+  ads1115->stop();
+  std::cout << "Config after stop: 0x" << std::hex << adc->getConfig() << std::dec << "\n";
+  
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file benchmarks/GpioBankBenchmark.cpp
+ * @author nikoapos
+ */
+
+/*
+ * Description
+ * -----------
+ * 
+ * Benchmark comparing the writing of a word to a group of GPIOs (like an 8 bit
+ * parallel bus) using one switch per pin against using a GPIO bank, which sets
+ * all the pins with a single call. It measures the words per second for:
+ * 
+ * - A loop of PigpioSwitch objects (one gpioWrite() per pin)
+ * - A PigpioGpioBank (gpioWrite_Bits_0_31_Set() and gpioWrite_Bits_0_31_Clear())
+ * - A loop of GpiocdevSwitch objects (one ioctl per pin)
+ * - A GpiocdevGpioBank (a single GPIO_V2_LINE_SET_VALUES ioctl)
+ * 
+ * Hardware setup:
+ * No hardware is needed, but the used GPIOs must be free, because they will
+ * be driven as outputs. By default the GPIOs 4, 5, 6, 12, 13, 16, 19 and 20
+ * are used.
+ * 
+ * Execution:
+ * Run the benchmark with root privileges (sudo), optionally giving the number
+ * of words to write as the first argument (default 100000).
+ */
+
+#include <iostream> // for std::cout
+#include <iomanip>  // for std::setw
+#include <chrono>   // for std::chrono::steady_clock
+#include <string>   // for std::string, std::stoul
+#include <vector>   // for std::vector
+#include <memory>   // for std::unique_ptr
+#include <functional> // for std::function
+#include <PiHWCtrl/HWInterfaces/Switch.h>
+#include <PiHWCtrl/pigpio/PigpioSwitch.h>
+#include <PiHWCtrl/pigpio/PigpioGpioBank.h>
+#include <PiHWCtrl/gpiocdev/GpiocdevSwitch.h>
+#include <PiHWCtrl/gpiocdev/GpiocdevGpioBank.h>
+
+namespace {
+
+const std::vector<int> gpios {4, 5, 6, 12, 13, 16, 19, 20};
+
+// Writes the given number of words using the given function and returns the
+// achieved words per second
+double measure(unsigned long words, std::function<void(std::uint32_t)> write) {
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned long i = 0; i < words; ++i) {
+    write(static_cast<std::uint32_t>(i));
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return words / elapsed.count();
+}
+
+// Writes a word by setting each switch separately
+void writePerPin(std::vector<std::unique_ptr<PiHWCtrl::Switch>>& switches,
+                 std::uint32_t word) {
+  for (std::size_t i = 0; i < switches.size(); ++i) {
+    switches[i]->set(word & (std::uint32_t{1} << i));
+  }
+}
+
+void report(const std::string& name, double words_per_sec) {
+  std::cout << std::left << std::setw(30) << name << std::right << std::setw(15)
+            << static_cast<long>(words_per_sec) << " words/sec\n";
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[]) {
+  
+  unsigned long words = (argc > 1) ? std::stoul(argv[1]) : 100000;
+  
+  // Each measurement is in its own scope, so the GPIOs are released before
+  // the next one reserves them
+  {
+    std::vector<std::unique_ptr<PiHWCtrl::Switch>> switches;
+    for (int gpio : gpios) {
+      switches.emplace_back(new PiHWCtrl::PigpioSwitch(gpio));
+    }
+    report("pigpio per pin loop", measure(words, [&switches](std::uint32_t word) {
+      writePerPin(switches, word);
+    }));
+  }
+  
+  {
+    PiHWCtrl::PigpioGpioBank bank {gpios};
+    report("PigpioGpioBank", measure(words, [&bank](std::uint32_t word) {
+      bank.write(word);
+    }));
+  }
+  
+  {
+    std::vector<std::unique_ptr<PiHWCtrl::Switch>> switches;
+    for (int gpio : gpios) {
+      switches.emplace_back(new PiHWCtrl::GpiocdevSwitch(gpio));
+    }
+    report("gpiocdev per pin loop", measure(words, [&switches](std::uint32_t word) {
+      writePerPin(switches, word);
+    }));
+  }
+  
+  {
+    PiHWCtrl::GpiocdevGpioBank bank {gpios};
+    report("GpiocdevGpioBank", measure(words, [&bank](std::uint32_t word) {
+      bank.write(word);
+    }));
+  }
+  
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file benchmarks/GpioValueBenchmark.cpp
+ * @author nikoapos
+ */
+
+/*
+ * Description
+ * -----------
+ * 
+ * Micro-benchmark comparing the two ways of accessing the sysfs value file of
+ * a GPIO:
+ * 
+ * - The old one, which constructs an std::ifstream / std::ofstream for every
+ *   access (open, read/write and close system calls)
+ * - The one used by the Gpio class, which keeps the file descriptor open and
+ *   uses a single pread() / pwrite() at offset 0
+ * 
+ * The benchmark does not need any hardware. It creates a fake sysfs tree in a
+ * temporary directory and it accesses the value file there.
+ * 
+ * Execution:
+ * Run the benchmark, optionally giving the number of iterations as the first
+ * argument (default 200000). It prints the operations per second for each of
+ * the access methods.
+ */
+
+#include <iostream> // for std::cout
+#include <iomanip>  // for std::setw
+#include <fstream>  // for std::ifstream, std::ofstream
+#include <chrono>   // for std::chrono::steady_clock
+#include <string>   // for std::string, std::stoul
+#include <functional> // for std::function
+#include <fcntl.h>  // for open()
+#include <unistd.h> // for pread(), pwrite() and close()
+#include <boost/filesystem.hpp>
+
+namespace {
+
+// Runs the given function the given number of times and returns the achieved
+// operations per second
+double measure(unsigned long iterations, std::function<void()> func) {
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned long i = 0; i < iterations; ++i) {
+    func();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return iterations / elapsed.count();
+}
+
+void report(const std::string& name, double ops_per_sec) {
+  std::cout << std::left << std::setw(30) << name << std::right << std::setw(15)
+            << static_cast<long>(ops_per_sec) << " ops/sec\n";
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[]) {
+  
+  unsigned long iterations = (argc > 1) ? std::stoul(argv[1]) : 200000;
+  
+  // Create the fake sysfs tree with the value file of a GPIO
+  auto root = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  auto gpio_dir = root / "class" / "gpio" / "gpio17";
+  boost::filesystem::create_directories(gpio_dir);
+  std::string value_file = (gpio_dir / "value").string();
+  {
+    std::ofstream out {value_file};
+    out << "0\n";
+  }
+  
+  std::cout << "Accessing " << value_file << ' ' << iterations << " times\n\n";
+  
+  // The old access method, creating a stream for every call
+  volatile bool sink = false;
+  report("stream read", measure(iterations, [&]() {
+    std::ifstream in {value_file};
+    sink = in.get() != '0';
+  }));
+  report("stream write", measure(iterations, [&]() {
+    std::ofstream out {value_file};
+    out << (sink ? "1" : "0");
+  }));
+  
+  // The new access method, keeping the file descriptor open
+  int fd = open(value_file.c_str(), O_RDWR);
+  if (fd < 0) {
+    std::cerr << "Failed to open " << value_file << '\n';
+    return 1;
+  }
+  report("persistent fd pread", measure(iterations, [&]() {
+    char value;
+    if (pread(fd, &value, 1, 0) == 1) {
+      sink = value != '0';
+    }
+  }));
+  report("persistent fd pwrite", measure(iterations, [&]() {
+    const char value = sink ? '1' : '0';
+    if (pwrite(fd, &value, 1, 0) != 1) {
+      sink = false;
+    }
+  }));
+  close(fd);
+  
+  boost::filesystem::remove_all(root);
+  
+}
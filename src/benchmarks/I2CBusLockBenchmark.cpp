@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file benchmarks/I2CBusLockBenchmark.cpp
+ * @author nikoapos
+ */
+
+/*
+ * Description
+ * -----------
+ * 
+ * Benchmark measuring how long a latency critical transaction waits for the
+ * I2C bus while other threads keep the bus busy. It compares:
+ * 
+ * - A plain std::mutex, which is what the I2CTransaction used to lock
+ * - The I2CBusLock, with the critical transaction using REALTIME priority
+ * 
+ * Several background threads do transactions back to back, like ADCs sampling
+ * as fast as possible, and one thread does a short transaction every 5ms, like
+ * a PWM update. The transactions are simulated by sleeping while holding the
+ * lock, so the benchmark does not need any hardware. It prints the percentiles
+ * of the time the critical transactions waited for the lock.
+ * 
+ * Execution:
+ * Run the benchmark, optionally giving the number of background threads and
+ * the duration in milliseconds as arguments (default 3 and 2000).
+ */
+
+#include <iostream> // for std::cout
+#include <iomanip>  // for std::setw
+#include <atomic>   // for std::atomic
+#include <chrono>   // for std::chrono::milliseconds
+#include <thread>   // for std::thread
+#include <mutex>    // for std::mutex
+#include <string>   // for std::string, std::stoul
+#include <vector>   // for std::vector
+#include <functional> // for std::function
+#include <PiHWCtrl/i2c/I2CBusLock.h>
+#include <PiHWCtrl/utils/LatencyHistogram.h>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// The duration of a sensor conversion read and of an actuator update
+constexpr auto BACKGROUND_TRANSACTION = 400us;
+constexpr auto REALTIME_TRANSACTION = 100us;
+constexpr auto REALTIME_PERIOD = 5ms;
+
+// Runs the background threads with the background lock functions and a
+// realtime thread with the realtime lock functions, and records the realtime
+// waits in the histogram
+void measure(unsigned int threads, std::chrono::milliseconds duration,
+             std::function<void()> background_lock, std::function<void()> realtime_lock,
+             std::function<void()> unlock, PiHWCtrl::LatencyHistogram& histogram) {
+  std::atomic<bool> running {true};
+  std::vector<std::thread> workers;
+  for (unsigned int i = 0; i < threads; ++i) {
+    workers.emplace_back([&]() {
+      while (running) {
+        background_lock();
+        std::this_thread::sleep_for(BACKGROUND_TRANSACTION);
+        unlock();
+      }
+    });
+  }
+  workers.emplace_back([&]() {
+    auto next = Clock::now();
+    while (running) {
+      next += REALTIME_PERIOD;
+      std::this_thread::sleep_until(next);
+      auto start = Clock::now();
+      realtime_lock();
+      histogram.record(Clock::now() - start);
+      std::this_thread::sleep_for(REALTIME_TRANSACTION);
+      unlock();
+    }
+  });
+  std::this_thread::sleep_for(duration);
+  running = false;
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+void report(const std::string& name, const PiHWCtrl::LatencyHistogram& histogram) {
+  auto us = [](std::chrono::nanoseconds d) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+  };
+  std::cout << std::left << std::setw(20) << name << std::right
+            << " p50 <= " << std::setw(6) << us(histogram.percentile(0.5)) << "us"
+            << " p99 <= " << std::setw(6) << us(histogram.percentile(0.99)) << "us"
+            << " max " << std::setw(6) << us(histogram.getSnapshot().max) << "us\n";
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[]) {
+  
+  unsigned int threads = (argc > 1) ? std::stoul(argv[1]) : 3;
+  std::chrono::milliseconds duration {(argc > 2) ? std::stoul(argv[2]) : 2000};
+  
+  {
+    std::mutex mutex;
+    auto lock = [&]() { mutex.lock(); };
+    auto unlock = [&]() { mutex.unlock(); };
+    PiHWCtrl::LatencyHistogram histogram;
+    measure(threads, duration, lock, lock, unlock, histogram);
+    report("std::mutex", histogram);
+  }
+  
+  {
+    PiHWCtrl::I2CBusLock bus_lock;
+    auto background_lock = [&]() { bus_lock.lock(PiHWCtrl::I2CBusLock::Priority::BACKGROUND); };
+    auto realtime_lock = [&]() { bus_lock.lock(PiHWCtrl::I2CBusLock::Priority::REALTIME); };
+    auto unlock = [&]() { bus_lock.unlock(); };
+    PiHWCtrl::LatencyHistogram histogram;
+    measure(threads, duration, background_lock, realtime_lock, unlock, histogram);
+    report("I2CBusLock", histogram);
+  }
+  
+}
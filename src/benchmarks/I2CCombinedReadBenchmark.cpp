@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file benchmarks/I2CCombinedReadBenchmark.cpp
+ * @author nikoapos
+ */
+
+/*
+ * Description
+ * -----------
+ * 
+ * Benchmark comparing the ways of reading a register of an I2C device:
+ * 
+ * - A write() of the register address followed by a read() of the data (two
+ *   system calls and a STOP condition between them)
+ * - A single I2C_RDWR ioctl with the write and read messages (one system call
+ *   and a repeated start), as used by the I2CBus
+ * - An SMBus I2C block read with the I2C_SMBUS ioctl
+ * 
+ * It prints the register reads per second for each method, or "not supported"
+ * if the adapter does not support it.
+ * 
+ * Hardware setup:
+ * Any I2C device can be used. Without hardware the i2c-stub kernel module can
+ * be used, for example with "sudo modprobe i2c-stub chip_addr=0x77", which
+ * creates a new adapter (check its number with "i2cdetect -l"). Note that the
+ * i2c-stub emulates only SMBus transfers, so only the last method works with
+ * it.
+ * 
+ * Execution:
+ * Run the benchmark giving the adapter number, the device address, the
+ * register address and the number of bytes to read (default 1, 0x77, 0xAA and
+ * 2), and optionally the number of reads (default 10000).
+ */
+
+#include <iostream> // for std::cout
+#include <iomanip>  // for std::setw
+#include <chrono>   // for std::chrono::steady_clock
+#include <string>   // for std::string, std::stoul
+#include <functional> // for std::function
+#include <cstdint>  // for std::uint8_t
+#include <fcntl.h>  // for open()
+#include <unistd.h> // for read(), write() and close()
+#include <sys/ioctl.h> // for ioctl()
+#include <linux/i2c.h> // for i2c_msg and i2c_smbus_data
+#include <linux/i2c-dev.h> // for I2C_SLAVE, I2C_RDWR and I2C_SMBUS
+
+namespace {
+
+// Runs the given read function the given number of times and prints the
+// achieved reads per second
+void measure(const std::string& name, unsigned long iterations, std::function<bool()> read_func) {
+  std::cout << std::left << std::setw(20) << name << std::right;
+  if (!read_func()) {
+    std::cout << std::setw(15) << "not supported" << '\n';
+    return;
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned long i = 0; i < iterations; ++i) {
+    if (!read_func()) {
+      std::cout << std::setw(15) << "failed" << '\n';
+      return;
+    }
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << std::setw(15) << static_cast<long>(iterations / elapsed.count()) << " reads/sec\n";
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[]) {
+  
+  int adapter = (argc > 1) ? std::stoi(argv[1]) : 1;
+  std::uint8_t address = (argc > 2) ? std::stoul(argv[2], nullptr, 0) : 0x77;
+  std::uint8_t reg = (argc > 3) ? std::stoul(argv[3], nullptr, 0) : 0xAA;
+  std::uint8_t size = (argc > 4) ? std::stoul(argv[4], nullptr, 0) : 2;
+  unsigned long iterations = (argc > 5) ? std::stoul(argv[5]) : 10000;
+  
+  std::string filename = "/dev/i2c-" + std::to_string(adapter);
+  int fd = open(filename.c_str(), O_RDWR);
+  if (fd < 0 || ioctl(fd, I2C_SLAVE, address) < 0) {
+    std::cout << "Failed to open " << filename << " for address " << (int) address << '\n';
+    return 1;
+  }
+  std::uint8_t buffer[I2C_SMBUS_BLOCK_MAX];
+  
+  measure("write() + read()", iterations, [&]() {
+    return write(fd, &reg, 1) == 1 && read(fd, buffer, size) == size;
+  });
+  
+  measure("I2C_RDWR", iterations, [&]() {
+    i2c_msg messages[2] = {
+      {address, 0, 1, &reg},
+      {address, I2C_M_RD, size, buffer}
+    };
+    i2c_rdwr_ioctl_data data {messages, 2};
+    return ioctl(fd, I2C_RDWR, &data) == 2;
+  });
+  
+  measure("SMBus block read", iterations, [&]() {
+    i2c_smbus_data data;
+    data.block[0] = size;
+    i2c_smbus_ioctl_data args {I2C_SMBUS_READ, reg, I2C_SMBUS_I2C_BLOCK_DATA, &data};
+    return ioctl(fd, I2C_SMBUS, &args) >= 0;
+  });
+  
+  close(fd);
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file benchmarks/I2CRequestQueueBenchmark.cpp
+ * @author nikoapos
+ */
+
+/*
+ * Description
+ * -----------
+ * 
+ * Benchmark comparing the synchronous and the asynchronous polling of several
+ * I2C devices. It creates a simulated 400 kHz bus with four ADS1115 devices
+ * (one for each address) at 860 SPS and it measures the conversions per second
+ * when:
+ * 
+ * - One thread reads the four devices one after the other, with the
+ *   readConversion(), sleeping during each conversion
+ * - One thread reads the four devices with the submitConversion() and waits for
+ *   the four futures, so the worker of the bus overlaps the conversions
+ * 
+ * It also prints the conversions of the last round, which must be the voltages
+ * set to the simulated devices (0.5V, 1.0V, 1.5V and 2.0V).
+ * 
+ * Execution:
+ * Run the benchmark, optionally giving the duration of each measurement in
+ * milliseconds as argument (default 1000).
+ */
+
+#include <iostream> // for std::cout
+#include <chrono>   // for std::chrono::milliseconds
+#include <string>   // for std::stoul
+#include <memory>   // for std::unique_ptr
+#include <vector>
+#include <future>   // for std::future
+#include <functional> // for std::function
+#include <PiHWCtrl/i2c/I2CBus.h>
+#include <PiHWCtrl/i2c/SimulatedI2CTransport.h>
+#include <PiHWCtrl/i2c/SimulatedI2CDevices.h>
+#include <PiHWCtrl/modules/ADS1115.h>
+
+namespace {
+
+// The simulated bus uses an adapter number which does not exist on the Pi
+constexpr int ADAPTER = 100;
+
+using AddressPin = PiHWCtrl::ADS1115::AddressPin;
+using Input = PiHWCtrl::ADS1115::Input;
+
+// Calls the function repeatedly for the given duration and returns the calls
+// per second
+double measure(std::chrono::milliseconds duration, std::function<void()> function) {
+  auto start = std::chrono::steady_clock::now();
+  auto end = start + duration;
+  long count = 0;
+  while (std::chrono::steady_clock::now() < end) {
+    function();
+    ++count;
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return count / elapsed.count();
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[]) {
+  
+  std::chrono::milliseconds duration {(argc > 1) ? std::stoul(argv[1]) : 1000};
+  
+  // Create the simulated bus with the four ADCs
+  std::uint8_t addresses[] = {0x48, 0x49, 0x4A, 0x4B};
+  auto transport = std::make_unique<PiHWCtrl::SimulatedI2CTransport>(
+                                      PiHWCtrl::SimulatedI2CTransport::FAST_MODE);
+  for (int i = 0; i < 4; ++i) {
+    auto adc = std::make_shared<PiHWCtrl::SimulatedADS1115>();
+    adc->setInputVoltage(0, 0.5 * (i + 1));
+    transport->addDevice(addresses[i], adc);
+  }
+  auto bus = PiHWCtrl::I2CBus::attach(ADAPTER, std::move(transport));
+  
+  std::vector<std::unique_ptr<PiHWCtrl::ADS1115>> adcs;
+  for (auto pin : {AddressPin::GND, AddressPin::VDD, AddressPin::SDA, AddressPin::SCL}) {
+    adcs.emplace_back(PiHWCtrl::ADS1115::factory(pin, PiHWCtrl::ADS1115::DataRate::DR_860_SPS,
+                                                 ADAPTER));
+  }
+  
+  std::vector<float> values (adcs.size());
+  
+  double sync_rate = measure(duration, [&]() {
+    for (std::size_t i = 0; i < adcs.size(); ++i) {
+      values[i] = adcs[i]->readConversion(Input::AIN0_GND);
+    }
+  });
+  std::cout << "Synchronous:  " << static_cast<long>(sync_rate * adcs.size()) << " conversions/s (";
+  for (auto value : values) {
+    std::cout << " " << value << "V";
+  }
+  std::cout << " )\n";
+  
+  std::vector<std::future<float>> futures (adcs.size());
+  double async_rate = measure(duration, [&]() {
+    for (std::size_t i = 0; i < adcs.size(); ++i) {
+      futures[i] = adcs[i]->submitConversion(Input::AIN0_GND);
+    }
+    for (std::size_t i = 0; i < adcs.size(); ++i) {
+      values[i] = futures[i].get();
+    }
+  });
+  std::cout << "Asynchronous: " << static_cast<long>(async_rate * adcs.size()) << " conversions/s (";
+  for (auto value : values) {
+    std::cout << " " << value << "V";
+  }
+  std::cout << " )\n";
+  
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file benchmarks/I2CSimulatorBenchmark.cpp
+ * @author nikoapos
+ */
+
+/*
+ * Description
+ * -----------
+ * 
+ * Benchmark running the I2C modules on simulated buses, so it does not need
+ * any hardware. For each bus speed (no transfer time, 100 kHz, 400 kHz and
+ * 1 MHz) it creates a bus with simulated ADS1115, BMP180 and PCA9685 devices
+ * and it measures:
+ * 
+ * - The PCA9685 duty cycle updates per second
+ * - The 22 byte block reads per second (the BMP180 calibration)
+ * - The ADS1115 single shot conversions per second, at 860 SPS
+ * - The BMP180 pressure readings per second (ultra low power mode)
+ * 
+ * It also prints the ADS1115 conversion of a 1.234V input and the BMP180
+ * temperature and pressure, which are deterministic (1.234V, 15.0C and
+ * 699.64hPa), to confirm that the modules work with the simulated devices.
+ * 
+ * Execution:
+ * Run the benchmark, optionally giving the duration of each measurement in
+ * milliseconds as argument (default 500).
+ */
+
+#include <iostream> // for std::cout
+#include <iomanip>  // for std::setw
+#include <chrono>   // for std::chrono::milliseconds
+#include <string>   // for std::stoul
+#include <memory>   // for std::shared_ptr
+#include <functional> // for std::function
+#include <PiHWCtrl/i2c/I2CBus.h>
+#include <PiHWCtrl/i2c/SimulatedI2CTransport.h>
+#include <PiHWCtrl/i2c/SimulatedI2CDevices.h>
+#include <PiHWCtrl/modules/ADS1115.h>
+#include <PiHWCtrl/modules/BMP180.h>
+#include <PiHWCtrl/modules/PCA9685.h>
+
+namespace {
+
+constexpr std::uint8_t ADS1115_ADDRESS = 0x48;
+constexpr std::uint8_t BMP180_ADDRESS = 0x77;
+constexpr std::uint8_t PCA9685_ADDRESS = 0x40;
+
+// The simulated buses use adapter numbers which do not exist on the Pi
+constexpr int FIRST_ADAPTER = 100;
+
+// Calls the function repeatedly for the given duration and returns the calls
+// per second
+double measure(std::chrono::milliseconds duration, std::function<void()> function) {
+  auto start = std::chrono::steady_clock::now();
+  auto end = start + duration;
+  long count = 0;
+  while (std::chrono::steady_clock::now() < end) {
+    function();
+    ++count;
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return count / elapsed.count();
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[]) {
+  
+  std::chrono::milliseconds duration {(argc > 1) ? std::stoul(argv[1]) : 500};
+  
+  unsigned int frequencies[] = {0, PiHWCtrl::SimulatedI2CTransport::STANDARD_MODE,
+                                PiHWCtrl::SimulatedI2CTransport::FAST_MODE,
+                                PiHWCtrl::SimulatedI2CTransport::FAST_MODE_PLUS};
+  
+  std::cout << std::setw(10) << "bus (Hz)" << std::setw(14) << "PWM upd/s"
+            << std::setw(14) << "22B reads/s" << std::setw(14) << "ADC conv/s"
+            << std::setw(14) << "pressure/s" << "\n";
+  
+  int adapter = FIRST_ADAPTER;
+  for (auto frequency : frequencies) {
+    
+    // Create the simulated bus with the devices
+    auto adc = std::make_shared<PiHWCtrl::SimulatedADS1115>();
+    adc->setInputVoltage(0, 1.234);
+    auto transport = std::make_unique<PiHWCtrl::SimulatedI2CTransport>(frequency);
+    transport->addDevice(ADS1115_ADDRESS, adc);
+    transport->addDevice(BMP180_ADDRESS, std::make_shared<PiHWCtrl::SimulatedBMP180>());
+    transport->addDevice(PCA9685_ADDRESS, std::make_shared<PiHWCtrl::SimulatedPCA9685>());
+    auto bus = PiHWCtrl::I2CBus::attach(adapter, std::move(transport));
+    
+    auto pwm = PiHWCtrl::PCA9685::factory(PCA9685_ADDRESS, 200, adapter);
+    auto ads1115 = PiHWCtrl::ADS1115::factory(PiHWCtrl::ADS1115::AddressPin::GND,
+                                              PiHWCtrl::ADS1115::DataRate::DR_860_SPS, adapter);
+    auto bmp180 = PiHWCtrl::BMP180::factory(PiHWCtrl::BMP180::PressureMode::ULTRA_LOW_POWER,
+                                            1020, "", adapter);
+    
+    if (adapter == FIRST_ADAPTER) {
+      std::cout << "(ADS1115 AIN0: " << ads1115->readConversion(PiHWCtrl::ADS1115::Input::AIN0_GND)
+                << "V, BMP180: " << bmp180->readTemperature() << "C "
+                << bmp180->readPressure() << "hPa)\n";
+    }
+    
+    int channel = 0;
+    double pwm_rate = measure(duration, [&]() {
+      pwm->setDutyCycle(channel, 0.5);
+      channel = (channel + 1) % 16;
+    });
+    
+    std::uint8_t calibration[22];
+    double block_rate = measure(duration, [&]() {
+      auto transaction = bus->startTransaction(BMP180_ADDRESS);
+      bus->readRegisterBlock(0xAA, calibration, sizeof(calibration));
+    });
+    
+    double adc_rate = measure(duration, [&]() {
+      ads1115->readConversion(PiHWCtrl::ADS1115::Input::AIN0_GND);
+    });
+    
+    double pressure_rate = measure(duration, [&]() {
+      bmp180->readRawPressure();
+    });
+    
+    std::cout << std::setw(10) << frequency << std::setw(14) << static_cast<long>(pwm_rate)
+              << std::setw(14) << static_cast<long>(block_rate)
+              << std::setw(14) << static_cast<long>(adc_rate)
+              << std::setw(14) << static_cast<long>(pressure_rate) << "\n";
+    ++adapter;
+  }
+  
+}
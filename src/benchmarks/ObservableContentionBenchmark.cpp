@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file benchmarks/ObservableContentionBenchmark.cpp
+ * @author nikoapos
+ */
+
+/*
+ * Description
+ * -----------
+ * 
+ * Benchmark measuring the notification throughput of an observable while
+ * other threads add and remove observers. It compares:
+ * 
+ * - The old way, where the modules had to protect the observable with a mutex
+ *   (both when notifying and when adding observers)
+ * - The copy on write Observable, which needs no external locking
+ * 
+ * Several threads generate events as fast as they can and one thread keeps
+ * subscribing and unsubscribing an observer. The benchmark prints the events
+ * per second of all the notifying threads together.
+ * 
+ * The benchmark does not need any hardware.
+ * 
+ * Execution:
+ * Run the benchmark, optionally giving the number of notifying threads and
+ * the duration in milliseconds as arguments (default 4 and 1000).
+ */
+
+#include <iostream> // for std::cout
+#include <iomanip>  // for std::setw
+#include <atomic>   // for std::atomic
+#include <chrono>   // for std::chrono::milliseconds
+#include <thread>   // for std::thread
+#include <mutex>    // for std::mutex
+#include <string>   // for std::string, std::stoul
+#include <vector>   // for std::vector
+#include <memory>   // for std::shared_ptr
+#include <functional> // for std::function
+#include <PiHWCtrl/utils/EncapsulatedObservable.h>
+
+namespace {
+
+class CountingObserver : public PiHWCtrl::Observer<int> {
+public:
+  void event(const int&) override {
+    m_count.fetch_add(1, std::memory_order_relaxed);
+  }
+private:
+  std::atomic<long> m_count {0};
+};
+
+// Runs the notify function in the given number of threads and the churn
+// function in one more thread, and returns the notifications per second
+double measure(unsigned int threads, std::chrono::milliseconds duration,
+               std::function<void()> notify, std::function<void()> churn) {
+  std::atomic<bool> running {true};
+  std::atomic<long> events {0};
+  std::vector<std::thread> workers;
+  for (unsigned int i = 0; i < threads; ++i) {
+    workers.emplace_back([&]() {
+      long count = 0;
+      while (running) {
+        notify();
+        ++count;
+      }
+      events += count;
+    });
+  }
+  workers.emplace_back([&]() {
+    while (running) {
+      churn();
+    }
+  });
+  std::this_thread::sleep_for(duration);
+  running = false;
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  return events / std::chrono::duration<double>(duration).count();
+}
+
+void report(const std::string& name, double events_per_sec) {
+  std::cout << std::left << std::setw(25) << name << std::right << std::setw(15)
+            << static_cast<long>(events_per_sec) << " events/sec\n";
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[]) {
+  
+  unsigned int threads = (argc > 1) ? std::stoul(argv[1]) : 4;
+  std::chrono::milliseconds duration {(argc > 2) ? std::stoul(argv[2]) : 1000};
+  
+  // Both observables have a few permanent observers
+  auto permanent = std::make_shared<CountingObserver>();
+  auto temporary = std::make_shared<CountingObserver>();
+  
+  {
+    PiHWCtrl::EncapsulatedObservable<int> observable;
+    std::mutex mutex;
+    for (int i = 0; i < 4; ++i) {
+      observable.addObserver(permanent);
+    }
+    auto notify = [&]() {
+      std::lock_guard<std::mutex> lock {mutex};
+      observable.createEvent(1);
+    };
+    auto churn = [&]() {
+      std::lock_guard<std::mutex> lock {mutex};
+      observable.addObserver(temporary);
+      observable.removeObserver(temporary);
+    };
+    report("mutex protected", measure(threads, duration, notify, churn));
+  }
+  
+  {
+    PiHWCtrl::EncapsulatedObservable<int> observable;
+    for (int i = 0; i < 4; ++i) {
+      observable.addObserver(permanent);
+    }
+    auto notify = [&]() {
+      observable.createEvent(1);
+    };
+    auto churn = [&]() {
+      auto subscription = observable.subscribe(temporary);
+    };
+    report("copy on write", measure(threads, duration, notify, churn));
+  }
+  
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file benchmarks/RingRecorderBenchmark.cpp
+ * @author nikoapos
+ */
+
+/*
+ * Description
+ * -----------
+ * 
+ * Benchmark comparing two ways of recording a stream of events, while another
+ * thread reads the recorded events in bulk:
+ * 
+ * - Pushing (timestamp, value) pairs into an std::vector protected by a mutex,
+ *   which the reader swaps with an empty one
+ * - The RingRecorder, which uses a preallocated lock-free ring buffer
+ * 
+ * For each of them it prints the events per second achieved by the producer and
+ * the cache misses of the process during the measurement (using the
+ * perf_event_open() system call, which prints n/a if the kernel does not allow
+ * it).
+ * 
+ * The benchmark does not need any hardware.
+ * 
+ * Execution:
+ * Run the benchmark, optionally giving the number of events as argument
+ * (default 10000000).
+ */
+
+#include <iostream> // for std::cout
+#include <iomanip>  // for std::setw
+#include <atomic>   // for std::atomic
+#include <chrono>   // for std::chrono::steady_clock
+#include <thread>   // for std::thread
+#include <mutex>    // for std::mutex
+#include <string>   // for std::string, std::stoul
+#include <vector>   // for std::vector
+#include <utility>  // for std::pair
+#include <functional> // for std::function
+#include <cstring>  // for std::memset
+#include <unistd.h> // for syscall(), read() and close()
+#include <sys/ioctl.h> // for ioctl()
+#include <sys/syscall.h> // for SYS_perf_event_open
+#include <linux/perf_event.h> // for perf_event_attr
+#include <PiHWCtrl/controls/RingRecorder.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Counts the cache misses of the process, if the kernel allows it
+class CacheMissCounter {
+public:
+  CacheMissCounter() {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    m_fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+  }
+  ~CacheMissCounter() {
+    if (m_fd >= 0) {
+      close(m_fd);
+    }
+  }
+  void start() {
+    if (m_fd >= 0) {
+      ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+  // Returns the cache misses since start() or -1 if not available
+  long long stop() {
+    long long count = -1;
+    if (m_fd >= 0) {
+      ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(m_fd, &count, sizeof(count)) != sizeof(count)) {
+        count = -1;
+      }
+    }
+    return count;
+  }
+private:
+  int m_fd;
+};
+
+// Runs the producer in the current thread and the consumer in a second thread
+// until the producer finishes, and prints the results
+void measure(const std::string& name, unsigned long events,
+             std::function<void(unsigned long)> produce, std::function<void()> consume) {
+  CacheMissCounter counter;
+  std::atomic<bool> running {true};
+  counter.start();
+  std::thread consumer {[&]() {
+    while (running) {
+      consume();
+    }
+    consume();
+  }};
+  auto start = Clock::now();
+  for (unsigned long i = 0; i < events; ++i) {
+    produce(i);
+  }
+  std::chrono::duration<double> elapsed = Clock::now() - start;
+  running = false;
+  consumer.join();
+  auto misses = counter.stop();
+  
+  std::cout << std::left << std::setw(20) << name << std::right << std::setw(12)
+            << static_cast<long>(events / elapsed.count()) << " events/sec   cache misses ";
+  if (misses < 0) {
+    std::cout << "n/a\n";
+  } else {
+    std::cout << misses << '\n';
+  }
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[]) {
+  
+  unsigned long events = (argc > 1) ? std::stoul(argv[1]) : 10000000;
+  constexpr std::size_t chunk = 1024;
+  
+  {
+    std::mutex mutex;
+    std::vector<std::pair<Clock::time_point, float>> records;
+    std::vector<std::pair<Clock::time_point, float>> drained;
+    unsigned long total = 0;
+    auto produce = [&](unsigned long i) {
+      std::lock_guard<std::mutex> lock {mutex};
+      records.emplace_back(Clock::now(), static_cast<float>(i));
+    };
+    auto consume = [&]() {
+      {
+        std::lock_guard<std::mutex> lock {mutex};
+        drained.swap(records);
+      }
+      total += drained.size();
+      drained.clear();
+    };
+    measure("vector + mutex", events, produce, consume);
+  }
+  
+  {
+    PiHWCtrl::RingRecorder<float> recorder {1 << 16};
+    std::vector<PiHWCtrl::RingRecorder<float>::Record> drained(chunk);
+    unsigned long total = 0;
+    auto produce = [&](unsigned long i) {
+      recorder.event(static_cast<float>(i));
+    };
+    auto consume = [&]() {
+      total += recorder.drain(drained.data(), drained.size());
+    };
+    measure("RingRecorder", events, produce, consume);
+    std::cout << "RingRecorder dropped " << recorder.getDroppedCount() << " events\n";
+  }
+  
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file benchmarks/SPIStreamWriterBenchmark.cpp
+ * @author nikoapos
+ */
+
+/*
+ * Description
+ * -----------
+ * 
+ * Benchmark of streaming an LED strip with the SPIStreamWriter. The colors of
+ * 10000 WS2812 LEDs are encoded with four SPI bits per LED bit (1000 for 0 and
+ * 1110 for 1), so each color byte becomes four SPI bytes (120 KB per frame),
+ * and the frames are sent:
+ * 
+ * - Synchronously, encoding a chunk of the size of the spidev buffer and
+ *   transferring it with the SPIBus::transfer(), one after the other
+ * - With the SPIStreamWriter::generate(), which encodes the next chunk while
+ *   the previous one is transferred
+ * 
+ * For each speed it prints the bytes per second of both methods. The
+ * benchmark needs the SPI0 bus of the Raspberry Pi (CE 0). Nothing needs to
+ * be connected to it.
+ * 
+ * Execution:
+ * Run the benchmark, optionally giving the number of frames for each
+ * measurement as argument (default 20).
+ */
+
+#include <iostream> // for std::cout
+#include <iomanip>  // for std::setw
+#include <chrono>   // for std::chrono::steady_clock
+#include <string>   // for std::stoi
+#include <utility>  // for std::pair
+#include <vector>
+#include <algorithm> // for std::min
+#include <functional> // for std::function
+#include <PiHWCtrl/spi/SPIBus.h>
+#include <PiHWCtrl/spi/SPIStreamWriter.h>
+
+namespace {
+
+constexpr std::size_t LEDS = 10000;
+constexpr std::size_t FRAME_SIZE = LEDS * 3 * 4;
+
+// Encodes the colors starting from the given SPI byte of the frame
+void encode(const std::vector<std::uint8_t>& colors, std::size_t offset,
+            std::uint8_t* out, std::size_t size) {
+  for (std::size_t i = 0; i < size; ++i) {
+    std::uint8_t color = colors[(offset + i) / 4];
+    // Each SPI byte contains two bits of the color, most significant first
+    int shift = 6 - 2 * ((offset + i) % 4);
+    std::uint8_t high = (color >> (shift + 1)) & 1;
+    std::uint8_t low = (color >> shift) & 1;
+    out[i] = (high ? 0xE0 : 0x80) | (low ? 0x0E : 0x08);
+  }
+}
+
+// Runs the given function, which sends a frame, the given number of times and
+// returns the bytes per second
+double measure(int frames, std::function<void()> func) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < frames; ++i) {
+    func();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return frames * FRAME_SIZE / elapsed.count();
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[]) {
+  
+  int frames = (argc > 1) ? std::stoi(argv[1]) : 20;
+  
+  std::vector<std::uint8_t> colors (LEDS * 3);
+  for (std::size_t i = 0; i < colors.size(); ++i) {
+    colors[i] = i * 37;
+  }
+  
+  std::cout << std::setw(12) << "speed" << std::setw(16) << "sync B/s" << std::setw(16) << "stream B/s\n";
+  std::pair<PiHWCtrl::SPIBus::Speed, std::string> speeds[] = {
+    {PiHWCtrl::SPIBus::Speed::S_3_9_MHz, "3.9 MHz"}, {PiHWCtrl::SPIBus::Speed::S_7_8_MHz, "7.8 MHz"},
+    {PiHWCtrl::SPIBus::Speed::S_15_6_MHz, "15.6 MHz"}, {PiHWCtrl::SPIBus::Speed::S_31_2_MHz, "31.2 MHz"}
+  };
+  for (auto& speed : speeds) {
+    PiHWCtrl::SPIBus bus {PiHWCtrl::SPIBus::Device::CE_0, speed.first};
+    
+    std::vector<std::uint8_t> chunk (bus.getMaxTransferSize());
+    double sync_rate = measure(frames, [&]() {
+      for (std::size_t offset = 0; offset < FRAME_SIZE; offset += chunk.size()) {
+        std::size_t size = std::min(chunk.size(), FRAME_SIZE - offset);
+        encode(colors, offset, chunk.data(), size);
+        bus.transfer(chunk.data(), nullptr, size);
+      }
+    });
+    
+    PiHWCtrl::SPIStreamWriter writer {bus};
+    double stream_rate = measure(frames, [&]() {
+      std::size_t offset = 0;
+      writer.generate(FRAME_SIZE, [&](std::uint8_t* buffer, std::size_t size) {
+        encode(colors, offset, buffer, size);
+        offset += size;
+      });
+      writer.flush();
+    });
+    
+    std::cout << std::setw(12) << speed.second << std::setw(16) << static_cast<long>(sync_rate)
+              << std::setw(16) << static_cast<long>(stream_rate) << "\n";
+  }
+  
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file benchmarks/SPITransferBenchmark.cpp
+ * @author nikoapos
+ */
+
+/*
+ * Description
+ * -----------
+ * 
+ * Benchmark of the SPI transfer methods, which measures the bytes per second
+ * of transferring a 64 KiB buffer:
+ * 
+ * - One byte per transfer, with the transfer<std::uint8_t>() (one ioctl per
+ *   byte)
+ * - 32 bytes per transfer, with the transferArray<32>()
+ * - The whole buffer with the runtime length transfer(tx, rx, size), which
+ *   sends a message per spidev buffer (bufsiz, 4096 bytes by default)
+ * - Messages of 16 segments with the transfer(segments, count), which sends
+ *   the same data as the previous with the chip select released between the
+ *   segments
+ * 
+ * The benchmark needs the SPI0 bus of the Raspberry Pi with the MOSI (GPIO 10)
+ * connected to the MISO (GPIO 9), so it can check that the received data are
+ * the transmitted ones (the same setup as the spi-loopback-test).
+ * 
+ * Execution:
+ * Run the benchmark, optionally giving the speed as the first argument (one of
+ * the SPIBus::Speed values as an index, default 10 for 7.8 MHz).
+ */
+
+#include <iostream> // for std::cout
+#include <iomanip>  // for std::setw
+#include <chrono>   // for std::chrono::steady_clock
+#include <string>   // for std::stoi
+#include <vector>
+#include <array>
+#include <algorithm> // for std::copy, std::fill and std::min
+#include <functional> // for std::function
+#include <PiHWCtrl/spi/SPIBus.h>
+
+namespace {
+
+constexpr std::size_t BUFFER_SIZE = 64 * 1024;
+constexpr std::size_t SEGMENTS = 16;
+
+// Runs the given function, which transfers the whole buffer, for about a
+// second and returns the bytes per second
+double measure(std::function<void()> func) {
+  auto start = std::chrono::steady_clock::now();
+  long count = 0;
+  while (std::chrono::steady_clock::now() - start < std::chrono::seconds(1)) {
+    func();
+    ++count;
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return count * BUFFER_SIZE / elapsed.count();
+}
+
+void report(const std::string& name, double rate, const std::vector<std::uint8_t>& tx,
+            std::vector<std::uint8_t>& rx) {
+  std::cout << std::setw(24) << name << std::setw(14) << static_cast<long>(rate) << " B/s"
+            << (tx == rx ? "" : "  (loopback data mismatch!)") << "\n";
+  std::fill(rx.begin(), rx.end(), 0);
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[]) {
+  
+  auto speed = static_cast<PiHWCtrl::SPIBus::Speed>((argc > 1) ? std::stoi(argv[1]) : 10);
+  PiHWCtrl::SPIBus bus {PiHWCtrl::SPIBus::Device::CE_0, speed};
+  
+  std::vector<std::uint8_t> tx (BUFFER_SIZE);
+  std::vector<std::uint8_t> rx (BUFFER_SIZE);
+  for (std::size_t i = 0; i < BUFFER_SIZE; ++i) {
+    tx[i] = i * 7 + 3;
+  }
+  
+  report("byte per transfer", measure([&]() {
+    for (std::size_t i = 0; i < BUFFER_SIZE; ++i) {
+      rx[i] = bus.transfer<std::uint8_t>(tx[i]);
+    }
+  }), tx, rx);
+  
+  report("32 byte arrays", measure([&]() {
+    std::array<std::uint8_t, 32> chunk;
+    for (std::size_t i = 0; i < BUFFER_SIZE; i += chunk.size()) {
+      std::copy(tx.begin() + i, tx.begin() + i + chunk.size(), chunk.begin());
+      auto result = bus.transferArray(chunk);
+      std::copy(result.begin(), result.end(), rx.begin() + i);
+    }
+  }), tx, rx);
+  
+  report("runtime length", measure([&]() {
+    bus.transfer(tx.data(), rx.data(), BUFFER_SIZE);
+  }), tx, rx);
+  
+  std::size_t message_size = bus.getMaxTransferSize();
+  std::size_t segment_size = message_size / SEGMENTS;
+  std::vector<PiHWCtrl::SPISegment> segments (SEGMENTS);
+  report("16 segment messages", measure([&]() {
+    for (std::size_t offset = 0; offset < BUFFER_SIZE; offset += segment_size * SEGMENTS) {
+      std::size_t count = 0;
+      for (; count < SEGMENTS && offset + count * segment_size < BUFFER_SIZE; ++count) {
+        std::size_t start = offset + count * segment_size;
+        segments[count] = PiHWCtrl::SPISegment{tx.data() + start, rx.data() + start,
+                                               std::min(segment_size, BUFFER_SIZE - start), true, 0, 0};
+      }
+      // The chip select of the last segment is released with the message
+      segments[count - 1].cs_change = false;
+      bus.transfer(segments.data(), count);
+    }
+  }), tx, rx);
+  
+}
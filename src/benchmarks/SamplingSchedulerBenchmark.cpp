@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file benchmarks/SamplingSchedulerBenchmark.cpp
+ * @author nikoapos
+ */
+
+/*
+ * Description
+ * -----------
+ * 
+ * Benchmark comparing two ways of periodically sampling many inputs:
+ * 
+ * - One thread per source, using the startEventGenerator(), which sleeps for
+ *   the period after every sample
+ * - The SamplingScheduler, which uses a single timer thread with absolute
+ *   deadlines and a small pool of workers
+ * 
+ * The sources are FunctionAnalogInput objects returning a constant, so the
+ * benchmark does not need any hardware. For each model it prints the jitter of
+ * the time between two consecutive samples of the same source (mean, 99th
+ * percentile and maximum), the drift (how many samples were lost compared to
+ * the ideal number) and the increase of the resident memory (RSS). Each model
+ * runs in its own child process.
+ * 
+ * Execution:
+ * Run the benchmark, optionally giving the number of sources, the period in
+ * milliseconds and the duration in seconds (default 1000, 10 and 3).
+ */
+
+#include <iostream> // for std::cout
+#include <iomanip>  // for std::setw
+#include <fstream>  // for std::ifstream
+#include <sstream>  // for std::istringstream
+#include <atomic>   // for std::atomic
+#include <chrono>   // for std::chrono::steady_clock
+#include <thread>   // for std::this_thread
+#include <string>   // for std::string, std::stoul
+#include <vector>   // for std::vector
+#include <memory>   // for std::unique_ptr
+#include <algorithm> // for std::sort
+#include <cmath>    // for std::abs
+#include <unistd.h> // for fork() and _exit()
+#include <sys/wait.h> // for waitpid()
+#include <PiHWCtrl/utils/FunctionAnalogInput.h>
+#include <PiHWCtrl/utils/EventGenerator.h>
+#include <PiHWCtrl/utils/SamplingScheduler.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// A simulated source, which keeps the times between its samples
+struct Source {
+  
+  Source(unsigned long expected_samples)
+          : input([]() { return 1.f; }) {
+    intervals.reserve(expected_samples + 10);
+  }
+  
+  void sample() {
+    input.readValue();
+    auto now = Clock::now();
+    if (samples > 0) {
+      intervals.push_back(std::chrono::duration<double, std::micro>(now - last).count());
+    }
+    last = now;
+    ++samples;
+  }
+  
+  PiHWCtrl::FunctionAnalogInput<float> input;
+  Clock::time_point last;
+  unsigned long samples = 0;
+  std::vector<double> intervals;
+  
+};
+
+// Returns the resident memory of the process in kB
+long residentMemory() {
+  std::ifstream status {"/proc/self/status"};
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 6, "VmRSS:") == 0) {
+      std::istringstream value {line.substr(6)};
+      long kb;
+      value >> kb;
+      return kb;
+    }
+  }
+  return -1;
+}
+
+void report(const std::string& name, const std::vector<std::unique_ptr<Source>>& sources,
+            double period_us, double duration_s, long rss_kb) {
+  std::vector<double> jitter;
+  double expected = sources.size() * duration_s * 1e6 / period_us;
+  double lost = expected;
+  for (auto& source : sources) {
+    for (double interval : source->intervals) {
+      jitter.push_back(std::abs(interval - period_us));
+    }
+    lost -= source->samples;
+  }
+  std::sort(jitter.begin(), jitter.end());
+  double sum = 0;
+  for (double j : jitter) {
+    sum += j;
+  }
+  std::cout << name << '\n' << std::fixed << std::setprecision(1)
+            << "  jitter mean    " << std::setw(10) << sum / jitter.size() << " us\n"
+            << "  jitter p99     " << std::setw(10) << jitter[jitter.size() * 99 / 100] << " us\n"
+            << "  jitter max     " << std::setw(10) << jitter.back() << " us\n"
+            << "  lost samples   " << std::setw(10) << 100. * lost / expected << " %\n"
+            << "  RSS increase   " << std::setw(10) << static_cast<double>(rss_kb) << " kB\n";
+}
+
+void runThreadPerSource(unsigned long n_sources, unsigned long period_ms,
+                        unsigned long duration_s) {
+  unsigned long expected_samples = duration_s * 1000 / period_ms;
+  std::vector<std::unique_ptr<Source>> sources;
+  std::vector<std::unique_ptr<std::atomic<bool>>> flags;
+  for (unsigned long i = 0; i < n_sources; ++i) {
+    sources.emplace_back(new Source{expected_samples});
+    flags.emplace_back(new std::atomic<bool>{true});
+  }
+  long rss_before = residentMemory();
+  for (unsigned long i = 0; i < n_sources; ++i) {
+    auto& source = *sources[i];
+    PiHWCtrl::startEventGenerator<int>([&source]() { source.sample(); return 0; },
+                                       [](int) {}, *flags[i], period_ms);
+  }
+  std::this_thread::sleep_for(std::chrono::seconds(duration_s));
+  long rss_after = residentMemory();
+  // Stop the threads, using the flag handshake of the EventGenerator
+  for (auto& flag : flags) {
+    *flag = false;
+  }
+  for (auto& flag : flags) {
+    while (!*flag) {
+      std::this_thread::yield();
+    }
+  }
+  report("Thread per source", sources, period_ms * 1000., duration_s, rss_after - rss_before);
+}
+
+void runScheduler(unsigned long n_sources, unsigned long period_ms,
+                  unsigned long duration_s) {
+  unsigned long expected_samples = duration_s * 1000 / period_ms;
+  std::vector<std::unique_ptr<Source>> sources;
+  for (unsigned long i = 0; i < n_sources; ++i) {
+    sources.emplace_back(new Source{expected_samples});
+  }
+  long rss_before = residentMemory();
+  PiHWCtrl::SamplingScheduler scheduler {};
+  std::vector<PiHWCtrl::SamplingScheduler::JobId> jobs;
+  for (auto& source : sources) {
+    auto& s = *source;
+    jobs.push_back(scheduler.schedule([&s]() { s.sample(); }, std::chrono::milliseconds(period_ms)));
+  }
+  std::this_thread::sleep_for(std::chrono::seconds(duration_s));
+  long rss_after = residentMemory();
+  for (auto job : jobs) {
+    scheduler.cancel(job);
+  }
+  report("SamplingScheduler", sources, period_ms * 1000., duration_s, rss_after - rss_before);
+}
+
+// Runs the given model in a child process, so the memory used by one model
+// does not affect the RSS measurement of the other
+template <typename Func>
+void runInChild(Func func) {
+  std::cout.flush();
+  pid_t pid = fork();
+  if (pid == 0) {
+    func();
+    std::cout.flush();
+    _exit(0);
+  }
+  waitpid(pid, nullptr, 0);
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[]) {
+  
+  unsigned long n_sources = (argc > 1) ? std::stoul(argv[1]) : 1000;
+  unsigned long period_ms = (argc > 2) ? std::stoul(argv[2]) : 10;
+  unsigned long duration_s = (argc > 3) ? std::stoul(argv[3]) : 3;
+  
+  runInChild([&]() { runThreadPerSource(n_sources, period_ms, duration_s); });
+  runInChild([&]() { runScheduler(n_sources, period_ms, duration_s); });
+  
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file benchmarks/SamplingWorkerPeriodBenchmark.cpp
+ * @author nikoapos
+ */
+
+/*
+ * Description
+ * -----------
+ * 
+ * Benchmark showing the difference between the EventGenerator and the
+ * SamplingWorker (used by the modules for their continuous measurement modes)
+ * when the task is slow (like the BMP180 pressure measurement, which takes up
+ * to 25.5 ms):
+ * 
+ * - The EventGenerator sleeps for the period after every event, so the real
+ *   period is the sleep time plus the time of the event function
+ * - The SamplingWorker sleeps until absolute deadlines, with both the SKIP and
+ *   CATCH_UP overrun policies
+ * 
+ * The simulated measurement takes 8 ms, and every tenth one takes 30 ms to
+ * produce overruns. The period is 20 ms. For every mode the benchmark prints
+ * the achieved rate, the jitter and the overruns.
+ * 
+ * The benchmark does not need any hardware.
+ * 
+ * Execution:
+ * Run the benchmark, optionally giving the duration of each mode in seconds
+ * as argument (default 2).
+ */
+
+#include <iostream> // for std::cout
+#include <iomanip>  // for std::setw
+#include <atomic>   // for std::atomic
+#include <chrono>   // for std::chrono::milliseconds
+#include <thread>   // for std::this_thread
+#include <string>   // for std::string, std::stoul
+#include <memory>   // for std::shared_ptr
+#include <PiHWCtrl/utils/EventGenerator.h>
+#include <PiHWCtrl/utils/PeriodStatistics.h>
+#include <PiHWCtrl/utils/SamplingWorker.h>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr auto period = 20ms;
+
+// Simulates a slow measurement
+int slowMeasurement() {
+  static thread_local int counter = 0;
+  std::this_thread::sleep_for((++counter % 10 == 0) ? 30ms : 8ms);
+  return counter;
+}
+
+// Waits for the generator to stop, using the flag handshake
+void stopGenerator(std::atomic<bool>& flag) {
+  flag = false;
+  while (!flag) {
+    std::this_thread::yield();
+  }
+  flag = false;
+}
+
+void report(const std::string& name, const PiHWCtrl::PeriodStatistics& statistics) {
+  auto snapshot = statistics.getSnapshot();
+  auto ms = [](std::chrono::nanoseconds ns) { return ns.count() / 1e6; };
+  std::cout << std::left << std::setw(20) << name << std::right << std::fixed
+            << std::setprecision(2)
+            << " rate " << std::setw(6) << snapshot.rate << " Hz"
+            << "   jitter min " << std::setw(7) << ms(snapshot.min_jitter)
+            << " max " << std::setw(7) << ms(snapshot.max_jitter)
+            << " p99 " << std::setw(7) << ms(snapshot.p99_jitter) << " ms"
+            << "   overruns " << snapshot.overruns << '\n';
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[]) {
+  
+  auto duration = std::chrono::seconds((argc > 1) ? std::stoul(argv[1]) : 2);
+  std::atomic<bool> flag {false};
+  auto no_notify = [](int) {};
+  
+  std::cout << "Nominal rate " << 1s / period << " Hz\n";
+  
+  {
+    // The EventGenerator does not collect statistics, so we record them from the
+    // event function
+    PiHWCtrl::PeriodStatistics statistics {period};
+    auto event_func = [&statistics]() {
+      statistics.recordExecution(std::chrono::steady_clock::now());
+      return slowMeasurement();
+    };
+    flag = true;
+    PiHWCtrl::startEventGenerator<int>(event_func, no_notify, flag,
+                                       std::chrono::milliseconds(period).count());
+    std::this_thread::sleep_for(duration);
+    stopGenerator(flag);
+    report("sleep", statistics);
+  }
+  
+  for (auto policy : {PiHWCtrl::OverrunPolicy::SKIP, PiHWCtrl::OverrunPolicy::CATCH_UP}) {
+    PiHWCtrl::SamplingWorker worker;
+    worker.start([]() { slowMeasurement(); }, period, nullptr, policy);
+    std::this_thread::sleep_for(duration);
+    worker.stop();
+    report(policy == PiHWCtrl::OverrunPolicy::SKIP ? "periodic SKIP" : "periodic CATCH_UP",
+           *worker.getStatistics());
+  }
+  
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file benchmarks/SamplingWorkerStopBenchmark.cpp
+ * @author nikoapos
+ */
+
+/*
+ * Description
+ * -----------
+ * 
+ * Benchmark measuring the latency and the CPU time spent by the stop() of the
+ * continuous measurement modes. It compares:
+ * 
+ * - The old way, where a detached EventGenerator thread is stopped by setting
+ *   a flag and busy waiting until the thread sets it back
+ * - The SamplingWorker, which wakes up the thread using a condition variable
+ *   and joins it
+ * 
+ * The sampling task simulates a slow measurement (like an ADC conversion) by
+ * sleeping, and the period simulates the sleep between the measurements. The
+ * CPU time is the one consumed by the thread calling the stop(), so the busy
+ * waiting shows up as a CPU time close to the latency.
+ * 
+ * The benchmark does not need any hardware.
+ * 
+ * Execution:
+ * Run the benchmark, optionally giving the measurement time and the period in
+ * milliseconds as arguments (default 5 and 100).
+ */
+
+#include <iostream> // for std::cout
+#include <iomanip>  // for std::setw
+#include <atomic>   // for std::atomic
+#include <chrono>   // for std::chrono::steady_clock
+#include <thread>   // for std::this_thread
+#include <string>   // for std::string, std::stoul
+#include <functional> // for std::function
+#include <time.h>   // for clock_gettime()
+#include <PiHWCtrl/utils/EventGenerator.h>
+#include <PiHWCtrl/utils/SamplingWorker.h>
+
+namespace {
+
+constexpr int repetitions = 10;
+
+// Returns the CPU time consumed by the calling thread, in milliseconds
+double threadCpuMs() {
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// Calls the given stop function several times (after letting the sampling run
+// for a while) and prints the average latency and CPU time of the calls
+void measure(const std::string& name, std::function<void()> start,
+             std::function<void()> stop, unsigned int period_ms) {
+  double total_latency = 0;
+  double total_cpu = 0;
+  for (int i = 0; i < repetitions; ++i) {
+    start();
+    // Stop at a different phase of the sampling cycle every time
+    std::this_thread::sleep_for(std::chrono::milliseconds(period_ms + i * period_ms / repetitions));
+    auto cpu_start = threadCpuMs();
+    auto wall_start = std::chrono::steady_clock::now();
+    stop();
+    std::chrono::duration<double, std::milli> latency = std::chrono::steady_clock::now() - wall_start;
+    total_latency += latency.count();
+    total_cpu += threadCpuMs() - cpu_start;
+  }
+  std::cout << std::left << std::setw(20) << name << std::right << std::fixed
+            << std::setprecision(3) << "latency " << std::setw(9)
+            << total_latency / repetitions << " ms    CPU " << std::setw(9)
+            << total_cpu / repetitions << " ms\n";
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[]) {
+  
+  unsigned int task_ms = (argc > 1) ? std::stoul(argv[1]) : 5;
+  unsigned int period_ms = (argc > 2) ? std::stoul(argv[2]) : 100;
+  
+  auto task = [task_ms]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(task_ms));
+    return 0;
+  };
+  
+  std::atomic<bool> observing {false};
+  auto busy_wait_start = [&]() {
+    observing = true;
+    PiHWCtrl::startEventGenerator<int>(task, [](int) {}, observing, period_ms);
+  };
+  auto busy_wait_stop = [&]() {
+    observing = false;
+    while (!observing) {
+    }
+    observing = false;
+  };
+  measure("busy wait", busy_wait_start, busy_wait_stop, period_ms);
+  
+  PiHWCtrl::SamplingWorker worker;
+  auto worker_start = [&]() {
+    worker.start(task, std::chrono::milliseconds(period_ms));
+  };
+  auto worker_stop = [&]() {
+    worker.stop();
+  };
+  measure("SamplingWorker", worker_start, worker_stop, period_ms);
+  
+}
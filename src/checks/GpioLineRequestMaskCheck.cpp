@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file checks/GpioLineRequestMaskCheck.cpp
+ * @author nikoapos
+ */
+
+/*
+ * Description
+ * -----------
+ * 
+ * Check of the mask handling of the GpioLineRequest::setValues(), using a
+ * simulated GPIO chip of the gpio-sim kernel module instead of hardware. It
+ * requests the lines 2-5 of the chip as outputs and it checks that:
+ * 
+ * - The default mask sets all the lines
+ * - A mask selecting some of the lines changes only those
+ * - The mask bits above the requested lines are ignored
+ * - A mask selecting only bits above the requested lines changes nothing and
+ *   does not throw (the kernel rejects an empty mask)
+ * 
+ * The values are read back with the getValues(), which for output lines
+ * returns the values they drive.
+ * 
+ * Execution:
+ * Load the gpio-sim module and create a chip with at least 6 lines through
+ * its configfs interface (see the gpio-sim kernel documentation), for example:
+ * 
+ *   modprobe gpio-sim
+ *   mkdir -p /sys/kernel/config/gpio-sim/check/bank0
+ *   echo 8 > /sys/kernel/config/gpio-sim/check/bank0/num_lines
+ *   echo 1 > /sys/kernel/config/gpio-sim/check/live
+ * 
+ * Then run the check, optionally giving the number N of the /dev/gpiochipN to
+ * use. Without it the first chip with a gpio-sim label is used. If there is no
+ * such chip the check is skipped with the exit code 77. Otherwise it prints the
+ * result of each check and it exits with a non zero code if any of them failed.
+ */
+
+#include <iostream> // for std::cout
+#include <string>   // for std::string, std::stoi
+#include <vector>
+#include <cstdint>
+#include <exception> // for std::exception
+#include <fcntl.h>  // for open()
+#include <unistd.h> // for close()
+#include <sys/ioctl.h> // for ioctl()
+#include <linux/gpio.h>
+#include <boost/filesystem.hpp>
+#include <PiHWCtrl/gpiocdev/GpioLineRequest.h>
+
+using namespace PiHWCtrl;
+
+namespace {
+
+// The exit code which marks a check as skipped
+constexpr int SKIPPED = 77;
+
+// The lines requested from the chip. The GpioManager accepts only the GPIOs
+// 2-28 of the Raspberry Pi, so the lines 0 and 1 are not used.
+const std::vector<int> LINES {2, 3, 4, 5};
+constexpr std::uint64_t ALL_LINES = 0xF;
+
+int failures = 0;
+
+void check(bool ok, const std::string& name) {
+  std::cout << (ok ? "PASS " : "FAIL ") << name << '\n';
+  if (!ok) {
+    ++failures;
+  }
+}
+
+// Returns the info of the /dev/gpiochipN, or false if it cannot be read
+bool chipInfo(int chip, gpiochip_info& info) {
+  std::string chip_name = "/dev/gpiochip" + std::to_string(chip);
+  int fd = open(chip_name.c_str(), O_RDWR | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  int res = ioctl(fd, GPIO_GET_CHIPINFO_IOCTL, &info);
+  close(fd);
+  return res == 0;
+}
+
+// Returns the number of the first chip with a gpio-sim label, or -1
+int findSimulatedChip() {
+  for (int chip = 0; boost::filesystem::exists("/dev/gpiochip" + std::to_string(chip)); ++chip) {
+    gpiochip_info info;
+    if (chipInfo(chip, info) && std::string{info.label}.find("gpio-sim") == 0) {
+      return chip;
+    }
+  }
+  return -1;
+}
+
+void runChecks(int chip) {
+  GpioLineRequest request {LINES, GpioLineRequest::Direction::OUTPUT,
+                           GpioLineRequest::Edge::NONE, 0, chip};
+  check((request.getValues() & ALL_LINES) == 0, "initial values are applied");
+  
+  request.setValues(ALL_LINES);
+  check((request.getValues() & ALL_LINES) == ALL_LINES, "default mask sets all the lines");
+  
+  request.setValues(0, 0b0101);
+  check((request.getValues() & ALL_LINES) == 0b1010, "mask selects the lines to set");
+  
+  request.setValues(0b0001 | ~ALL_LINES, ~std::uint64_t{0});
+  check((request.getValues() & ALL_LINES) == 0b0001, "mask bits above the lines are ignored");
+  
+  request.setValues(~std::uint64_t{0}, std::uint64_t{1} << 40);
+  check((request.getValues() & ALL_LINES) == 0b0001, "mask with only bits above the lines is a no-op");
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[]) {
+  
+  int chip = (argc > 1) ? std::stoi(argv[1]) : findSimulatedChip();
+  gpiochip_info info;
+  if (chip < 0 || !chipInfo(chip, info)) {
+    std::cout << "No gpio-sim chip found, check skipped\n";
+    return SKIPPED;
+  }
+  if (info.lines < 6) {
+    std::cout << "The chip " << info.name << " has only " << info.lines
+              << " lines (at least 6 needed), check skipped\n";
+    return SKIPPED;
+  }
+  std::cout << "Using " << info.name << " (" << info.label << ")\n";
+  
+  try {
+    runChecks(chip);
+  } catch (const std::exception& e) {
+    check(false, std::string{"unexpected exception: "} + e.what());
+  }
+  
+  std::cout << (failures == 0 ? "All checks passed\n" : "Some checks failed\n");
+  return failures == 0 ? 0 : 1;
+}
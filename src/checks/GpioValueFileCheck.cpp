@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file checks/GpioValueFileCheck.cpp
+ * @author nikoapos
+ */
+
+/*
+ * Description
+ * -----------
+ * 
+ * Check of the GpioValueFile, which the Gpio class uses for accessing the
+ * sysfs value file with pread() / pwrite() at offset 0. It uses a fake value
+ * file in a temporary directory, so it does not need any hardware. It checks
+ * that:
+ * 
+ * - Consecutive reads and writes always access the first character, so the
+ *   file offset never moves
+ * - The writes keep the rest of the file (the newline of the sysfs file)
+ * - Writing a file opened for reading and opening a missing file throw a
+ *   GpioException
+ * - The waitForEdge() is interrupted by an eventfd, which it drains. A regular
+ *   file never signals POLLPRI, so the eventfd is the only way out.
+ * 
+ * Execution:
+ * Run the check without arguments. It prints the result of each check and it
+ * exits with a non zero code if any of them failed.
+ */
+
+#include <iostream> // for std::cout
+#include <fstream>  // for std::ifstream, std::ofstream
+#include <string>   // for std::string
+#include <iterator> // for std::istreambuf_iterator
+#include <thread>   // for std::thread
+#include <chrono>   // for std::chrono_literals
+#include <cstdint>
+#include <exception> // for std::exception
+#include <sys/eventfd.h> // for eventfd()
+#include <unistd.h> // for read(), write() and close()
+#include <boost/filesystem.hpp>
+#include <PiHWCtrl/gpio/GpioValueFile.h>
+#include <PiHWCtrl/gpio/exceptions.h>
+
+using namespace std::chrono_literals;
+using namespace PiHWCtrl;
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& name) {
+  std::cout << (ok ? "PASS " : "FAIL ") << name << '\n';
+  if (!ok) {
+    ++failures;
+  }
+}
+
+std::string fileContent(const std::string& filename) {
+  std::ifstream in {filename};
+  return std::string {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+void runChecks(const boost::filesystem::path& root) {
+  
+  // Create a fake value file, like the ones of the sysfs
+  std::string value_file = (root / "value").string();
+  {
+    std::ofstream out {value_file};
+    out << "0\n";
+  }
+  
+  {
+    GpioValueFile file {value_file, true};
+    check(file.read() == false, "initial value is read");
+  
+    // With read() / write() instead of pread() / pwrite() the second access
+    // would hit the end of the file
+    bool consistent = true;
+    for (int i = 0; i < 1000; ++i) {
+      bool value = (i % 3) != 0;
+      file.write(value);
+      consistent = consistent && file.read() == value && file.read() == value;
+    }
+    check(consistent, "repeated writes and reads access offset 0");
+  
+    file.write(true);
+    check(fileContent(value_file) == "1\n", "write keeps the rest of the file");
+    file.write(false);
+    check(fileContent(value_file) == "0\n", "write of false gives '0'");
+  
+    // A value changed by somebody else (the driver) is seen by the next read
+    {
+      std::ofstream out {value_file};
+      out << "1\n";
+    }
+    check(file.read() == true, "external change is read");
+  }
+  
+  {
+    GpioValueFile file {value_file, false};
+    bool thrown = false;
+    try {
+      file.write(true);
+    } catch (const GpioException&) {
+      thrown = true;
+    }
+    check(thrown, "write to read-only file throws");
+  }
+  
+  {
+    bool thrown = false;
+    try {
+      GpioValueFile file {(root / "missing").string(), false};
+    } catch (const GpioException&) {
+      thrown = true;
+    }
+    check(thrown, "missing file throws");
+  }
+  
+  {
+    GpioValueFile file {value_file, false};
+    int interrupt_fd = eventfd(0, EFD_NONBLOCK);
+    std::thread interrupter {[interrupt_fd]() {
+      std::this_thread::sleep_for(50ms);
+      std::uint64_t one = 1;
+      write(interrupt_fd, &one, sizeof(one));
+    }};
+    bool edge = file.waitForEdge(interrupt_fd);
+    interrupter.join();
+    check(!edge, "waitForEdge() is interrupted by the eventfd");
+    std::uint64_t counter;
+    check(read(interrupt_fd, &counter, sizeof(counter)) < 0, "waitForEdge() drains the eventfd");
+    close(interrupt_fd);
+  }
+}
+
+} // end of anonymous namespace
+
+int main() {
+  
+  auto root = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  boost::filesystem::create_directories(root);
+  try {
+    runChecks(root);
+  } catch (const std::exception& e) {
+    check(false, std::string{"unexpected exception: "} + e.what());
+  }
+  boost::filesystem::remove_all(root);
+  
+  std::cout << (failures == 0 ? "All checks passed\n" : "Some checks failed\n");
+  return failures == 0 ? 0 : 1;
+}
@@ -47,6 +47,13 @@ std::map<Gpio::Mode, std::string> mode_map {
   {Gpio::Mode::OUTPUT, "out"}
 };
 
+std::map<Gpio::Edge, std::string> edge_map {
+  {Gpio::Edge::NONE, "none"},
+  {Gpio::Edge::RISING, "rising"},
+  {Gpio::Edge::FALLING, "falling"},
+  {Gpio::Edge::BOTH, "both"}
+};
+
 } // end of anonymous namespace
 
 Gpio::GpioExporter::GpioExporter(int gpio_no) : m_gpio_no(gpio_no) {
@@ -84,30 +91,37 @@ Gpio::Gpio(int gpio_no, Mode mode) {
   m_gpio_exporter = std::make_unique<GpioExporter>(gpio_no);
   
   // Set the mode
-  std::string gpio_dir {gpio_path + "/gpio" + std::to_string(gpio_no)};
-  std::string direction_file {gpio_dir + "/direction"};
+  m_gpio_dir = gpio_path + "/gpio" + std::to_string(gpio_no);
+  std::string direction_file {m_gpio_dir + "/direction"};
   {
     std::ofstream out {direction_file};
     out << mode_map[mode];
   }
   
-  // Store the name of the value file that will be used
-  m_value_file = gpio_dir + "/value";
+  // Open the value file once, so we do not pay for opening and closing it
+  // every time we access the state
+  m_value_file = std::make_unique<GpioValueFile>(m_gpio_dir + "/value", mode == Mode::OUTPUT);
 }
 
 bool Gpio::getState() const {
-  std::ifstream in {m_value_file};
-  auto value = in.get();
-  return (value == '0') ? false : true;
+  return m_value_file->read();
 }
 
 void Gpio::setState(bool state) {
-  std::ofstream out {m_value_file};
-  if (state) {
-    out << "1";
-  } else {
-    out << "0";
+  m_value_file->write(state);
+}
+
+void Gpio::setEdge(Edge edge) {
+  std::ofstream out {m_gpio_dir + "/edge"};
+  out << edge_map.at(edge) << std::flush;
+  if (!out) {
+    throw GpioException() << "Failed to set the edge of " << m_gpio_dir
+                          << " to " << edge_map.at(edge);
   }
 }
 
+bool Gpio::waitForEdge(int interrupt_fd) const {
+  return m_value_file->waitForEdge(interrupt_fd);
+}
+
 } // end of namespace PiHWCtrl
\ No newline at end of file
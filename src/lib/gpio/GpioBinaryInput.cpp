@@ -20,18 +20,29 @@
  * @author nikoapos
  */
 
-#include <PiHWCtrl/utils/EventGenerator.h>
+#include <cstdint>
+#include <cerrno>
+#include <cstring> // for std::strerror
+#include <chrono>
+#include <unistd.h> // for write() and close()
+#include <sys/eventfd.h> // for eventfd()
 #include <PiHWCtrl/gpio/GpioBinaryInput.h>
 #include <PiHWCtrl/gpio/exceptions.h>
 
 namespace PiHWCtrl {
 
 GpioBinaryInput::GpioBinaryInput(int gpio) : m_gpio(gpio, Gpio::Mode::INPUT) {
+  // The eventfd is used by the stop() to wake up a thread waiting for edges
+  m_wakeup_fd = eventfd(0, EFD_NONBLOCK);
+  if (m_wakeup_fd < 0) {
+    throw GpioException() << "Failed to create eventfd: " << std::strerror(errno);
+  }
 }
 
 GpioBinaryInput::~GpioBinaryInput() {
   // Stop any threads generating events for this GPIO
   stop();
+  close(m_wakeup_fd);
 }
 
 bool GpioBinaryInput::isOn() const {
@@ -40,28 +51,45 @@ bool GpioBinaryInput::isOn() const {
 }
 
 void GpioBinaryInput::start(unsigned int sleep_ms) {
-  if (m_observing) {
+  if (m_poll_job != 0 || m_worker.isRunning()) {
     throw GpioException() << "GPIO already started";
   }
-  m_observing = true;
-  auto event_func = [this]() {
-    return isOn();
+  auto poll_task = [this]() {
+    notifyObservers(isOn());
   };
-  auto notify_func = [this](bool value) {
-    notifyObservers(value);
+  m_poll_job = m_scheduler->schedule(poll_task, std::chrono::milliseconds(sleep_ms));
+}
+
+void GpioBinaryInput::startOnEdge(Gpio::Edge edge) {
+  if (m_poll_job != 0 || m_worker.isRunning()) {
+    throw GpioException() << "GPIO already started";
+  }
+  m_gpio.setEdge(edge);
+  // Read the state once, so edges which happened before are acknowledged
+  isOn();
+  
+  auto edge_task = [this]() {
+    if (m_gpio.waitForEdge(m_wakeup_fd)) {
+      // Reading the state also acknowledges the edge to the driver
+      notifyObservers(isOn());
+    }
+  };
+  // The eventfd wakes up the thread if it is waiting for an edge
+  auto wakeup = [this]() {
+    std::uint64_t one = 1;
+    write(m_wakeup_fd, &one, sizeof(one));
   };
-  startEventGenerator<bool>(event_func, notify_func, m_observing, sleep_ms);
+  m_worker.start(edge_task, std::chrono::nanoseconds{0}, wakeup);
 }
 
 void GpioBinaryInput::stop() {
-  if (m_observing) {
-    // This will trigger the EventGenerator thread to stop
-    m_observing = false;
-    // We have to wait until the thread signals that it stopped
-    while (!m_observing) {
-    }
-    // Now we can set again the flag to false
-    m_observing = false;
+  if (m_poll_job != 0) {
+    m_scheduler->cancel(m_poll_job);
+    m_poll_job = 0;
+  }
+  if (m_worker.isRunning()) {
+    m_worker.stop();
+    m_gpio.setEdge(Gpio::Edge::NONE);
   }
 }
 
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file lib/gpio/GpioValueFile.cpp
+ * @author nikoapos
+ */
+
+#include <array>
+#include <cerrno>
+#include <cstring> // for std::strerror
+#include <cstdint>
+#include <fcntl.h> // for open()
+#include <unistd.h> // for pread(), pwrite(), read() and close()
+#include <poll.h> // for poll()
+#include <PiHWCtrl/gpio/GpioValueFile.h>
+#include <PiHWCtrl/gpio/exceptions.h>
+
+namespace PiHWCtrl {
+
+GpioValueFile::GpioValueFile(const std::string& filename, bool writable)
+        : m_filename(filename) {
+  m_fd = open(m_filename.c_str(), writable ? O_RDWR : O_RDONLY);
+  if (m_fd < 0) {
+    throw GpioException() << "Failed to open " << m_filename << ": "
+                          << std::strerror(errno);
+  }
+}
+
+GpioValueFile::~GpioValueFile() {
+  close(m_fd);
+}
+
+bool GpioValueFile::read() const {
+  // The sysfs value file must always be read from its beginning, so we use
+  // pread() at offset 0 instead of seeking before every read
+  char value;
+  if (pread(m_fd, &value, 1, 0) != 1) {
+    throw GpioException() << "Failed to read " << m_filename << ": "
+                          << std::strerror(errno);
+  }
+  return (value == '0') ? false : true;
+}
+
+void GpioValueFile::write(bool value) {
+  const char c = value ? '1' : '0';
+  if (pwrite(m_fd, &c, 1, 0) != 1) {
+    throw GpioException() << "Failed to write " << m_filename << ": "
+                          << std::strerror(errno);
+  }
+}
+
+bool GpioValueFile::waitForEdge(int interrupt_fd) const {
+  // The sysfs driver signals the edges as POLLPRI events on the value file
+  std::array<pollfd, 2> fds {{
+    {m_fd, POLLPRI | POLLERR, 0},
+    {interrupt_fd, POLLIN, 0}
+  }};
+  nfds_t nfds = (interrupt_fd < 0) ? 1 : 2;
+  
+  for (;;) {
+    if (poll(fds.data(), nfds, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw GpioException() << "Failed to poll " << m_filename << ": "
+                            << std::strerror(errno);
+    }
+    // Cancellation has priority over the edge
+    if (nfds == 2 && (fds[1].revents & POLLIN)) {
+      std::uint64_t counter;
+      ::read(interrupt_fd, &counter, sizeof(counter));
+      return false;
+    }
+    if (fds[0].revents & (POLLPRI | POLLERR)) {
+      return true;
+    }
+  }
+}
+
+const std::string& GpioValueFile::getFilename() const {
+  return m_filename;
+}
+
+} // end of namespace PiHWCtrl
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file gpiocdev/GpioLineRequest.cpp
+ * @author nikoapos
+ */
+
+#include <string>
+#include <cstring> // for std::memset, std::strncpy
+#include <array>
+#include <fcntl.h> // for open()
+#include <unistd.h> // for read() and close()
+#include <poll.h> // for poll()
+#include <sys/ioctl.h> // for ioctl()
+#include <linux/gpio.h>
+#include <PiHWCtrl/utils/GpioManager.h>
+#include <PiHWCtrl/gpiocdev/GpioLineRequest.h>
+#include <PiHWCtrl/gpiocdev/exceptions.h>
+
+namespace PiHWCtrl {
+
+namespace {
+
+const char CONSUMER[] = "PiHWCtrl";
+
+std::uint64_t edgeFlags(GpioLineRequest::Edge edge) {
+  switch (edge) {
+    case GpioLineRequest::Edge::RISING:
+      return GPIO_V2_LINE_FLAG_EDGE_RISING;
+    case GpioLineRequest::Edge::FALLING:
+      return GPIO_V2_LINE_FLAG_EDGE_FALLING;
+    case GpioLineRequest::Edge::BOTH:
+      return GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING;
+    default:
+      return 0;
+  }
+}
+
+} // end of anonymous namespace
+
+GpioLineRequest::GpioLineRequest(const std::vector<int>& gpios, Direction direction,
+                                 Edge edge, std::uint64_t initial_values, int chip)
+        : m_gpios(gpios) {
+  
+  if (m_gpios.empty() || m_gpios.size() > GPIO_V2_LINES_MAX) {
+    throw Exception() << "Invalid number of GPIO lines " << m_gpios.size()
+                      << " (must be in range [1, " << GPIO_V2_LINES_MAX << "])";
+  }
+  
+  // Reserve the GPIOs so no other PiHWCtrl object can use them
+  for (int gpio : m_gpios) {
+    m_reservations.push_back(GpioManager::getSingleton()->reserveGpio(gpio));
+  }
+  
+  // Prepare the request for all the lines
+  gpio_v2_line_request request;
+  std::memset(&request, 0, sizeof(request));
+  for (std::size_t i = 0; i < m_gpios.size(); ++i) {
+    request.offsets[i] = m_gpios[i];
+  }
+  request.num_lines = m_gpios.size();
+  std::strncpy(request.consumer, CONSUMER, sizeof(request.consumer) - 1);
+  if (direction == Direction::INPUT) {
+    request.config.flags = GPIO_V2_LINE_FLAG_INPUT | edgeFlags(edge);
+  } else {
+    request.config.flags = GPIO_V2_LINE_FLAG_OUTPUT;
+    // The initial values are set as an attribute applying to all the lines
+    request.config.num_attrs = 1;
+    request.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+    request.config.attrs[0].attr.values = initial_values;
+    request.config.attrs[0].mask = ~std::uint64_t{0};
+  }
+  
+  // The chip file is only needed for creating the request. Afterwards all the
+  // communication goes through the file descriptor of the request.
+  std::string chip_name = "/dev/gpiochip" + std::to_string(chip);
+  int chip_fd = open(chip_name.c_str(), O_RDWR | O_CLOEXEC);
+  if (chip_fd < 0) {
+    throw GpioChipOpenFailure(chip_name);
+  }
+  int res = ioctl(chip_fd, GPIO_V2_GET_LINE_IOCTL, &request);
+  close(chip_fd);
+  if (res < 0) {
+    throw GpiocdevException("Failed to request lines from " + chip_name);
+  }
+  m_line_fd = request.fd;
+}
+
+GpioLineRequest::~GpioLineRequest() {
+  close(m_line_fd);
+}
+
+const std::vector<int>& GpioLineRequest::getGpios() const {
+  return m_gpios;
+}
+
+std::uint64_t GpioLineRequest::getValues() const {
+  gpio_v2_line_values values;
+  values.bits = 0;
+  values.mask = ~std::uint64_t{0};
+  if (ioctl(m_line_fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) < 0) {
+    throw GpiocdevException("Failed to read GPIO line values");
+  }
+  return values.bits;
+}
+
+void GpioLineRequest::setValues(std::uint64_t values, std::uint64_t mask) {
+  // The kernel ignores the mask bits above the requested lines, but they are
+  // masked out explicitly, so a mask selecting only such bits becomes empty.
+  // The kernel rejects an empty mask, so there is nothing to set then.
+  if (m_gpios.size() < 64) {
+    mask &= (std::uint64_t{1} << m_gpios.size()) - 1;
+  }
+  if (mask == 0) {
+    return;
+  }
+  gpio_v2_line_values line_values;
+  line_values.bits = values;
+  line_values.mask = mask;
+  if (ioctl(m_line_fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &line_values) < 0) {
+    throw GpiocdevException("Failed to set GPIO line values");
+  }
+}
+
+bool GpioLineRequest::waitForEvent(Event& event, int interrupt_fd) const {
+  std::array<pollfd, 2> fds {{
+    {m_line_fd, POLLIN, 0},
+    {interrupt_fd, POLLIN, 0}
+  }};
+  nfds_t nfds = (interrupt_fd < 0) ? 1 : 2;
+  
+  for (;;) {
+    if (poll(fds.data(), nfds, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw GpiocdevException("Failed to poll GPIO lines");
+    }
+    // Cancellation has priority over the events
+    if (nfds == 2 && (fds[1].revents & POLLIN)) {
+      std::uint64_t counter;
+      read(interrupt_fd, &counter, sizeof(counter));
+      return false;
+    }
+    if (fds[0].revents & POLLIN) {
+      gpio_v2_line_event line_event;
+      if (read(m_line_fd, &line_event, sizeof(line_event)) != sizeof(line_event)) {
+        throw GpiocdevException("Failed to read GPIO line event");
+      }
+      event.gpio = line_event.offset;
+      event.rising = line_event.id == GPIO_V2_LINE_EVENT_RISING_EDGE;
+      event.timestamp = std::chrono::nanoseconds(line_event.timestamp_ns);
+      return true;
+    }
+  }
+}
+
+} // end of namespace PiHWCtrl
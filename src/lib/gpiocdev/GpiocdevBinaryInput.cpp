@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file gpiocdev/GpiocdevBinaryInput.cpp
+ * @author nikoapos
+ */
+
+#include <cstdint>
+#include <chrono>
+#include <unistd.h> // for write() and close()
+#include <sys/eventfd.h> // for eventfd()
+#include <PiHWCtrl/gpiocdev/GpiocdevBinaryInput.h>
+#include <PiHWCtrl/gpiocdev/exceptions.h>
+
+namespace PiHWCtrl {
+
+GpiocdevBinaryInput::GpiocdevBinaryInput(int gpio, GpioLineRequest::Edge edge, int chip)
+        : m_line({gpio}, GpioLineRequest::Direction::INPUT, edge, 0, chip) {
+  // The eventfd is used by the stop() to wake up the thread waiting for edges
+  m_wakeup_fd = eventfd(0, EFD_NONBLOCK);
+  if (m_wakeup_fd < 0) {
+    throw GpiocdevException("Failed to create eventfd");
+  }
+}
+
+GpiocdevBinaryInput::~GpiocdevBinaryInput() {
+  // Stop any threads generating events for this GPIO
+  stop();
+  close(m_wakeup_fd);
+}
+
+bool GpiocdevBinaryInput::isOn() const {
+  return m_line.getValues() & 1;
+}
+
+void GpiocdevBinaryInput::addEdgeEventObserver(std::shared_ptr<Observer<GpioLineRequest::Event>> observer) {
+  m_edge_event_observable.addObserver(observer);
+}
+
+void GpiocdevBinaryInput::start() {
+  if (m_worker.isRunning()) {
+    throw Exception() << "GPIO already started";
+  }
+  
+  auto edge_task = [this]() {
+    GpioLineRequest::Event event;
+    if (m_line.waitForEvent(event, m_wakeup_fd)) {
+      // The kernel tells us the direction of the edge, so we do not need to
+      // read the line again
+      notifyObservers(event.rising);
+      m_edge_event_observable.createEvent(event);
+    }
+  };
+  // The eventfd wakes up the thread if it is waiting for an edge
+  auto wakeup = [this]() {
+    std::uint64_t one = 1;
+    write(m_wakeup_fd, &one, sizeof(one));
+  };
+  m_worker.start(edge_task, std::chrono::nanoseconds{0}, wakeup);
+}
+
+void GpiocdevBinaryInput::stop() {
+  m_worker.stop();
+}
+
+} // end of namespace PiHWCtrl
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file gpiocdev/GpiocdevGpioBank.cpp
+ * @author nikoapos
+ */
+
+#include <PiHWCtrl/HWInterfaces/exceptions.h>
+#include <PiHWCtrl/gpiocdev/GpiocdevGpioBank.h>
+
+namespace PiHWCtrl {
+
+namespace {
+
+const std::vector<int>& checkSize(const std::vector<int>& gpios) {
+  if (gpios.size() > 32) {
+    throw Exception() << "A GPIO bank can have maximum 32 GPIOs";
+  }
+  return gpios;
+}
+
+} // end of anonymous namespace
+
+GpiocdevGpioBank::GpiocdevGpioBank(const std::vector<int>& gpios,
+                                   GpioLineRequest::Direction direction, int chip)
+        : m_lines(checkSize(gpios), direction, GpioLineRequest::Edge::NONE, 0, chip),
+          m_direction(direction) {
+}
+
+void GpiocdevGpioBank::write(std::uint32_t word) {
+  if (m_direction == GpioLineRequest::Direction::INPUT) {
+    throw Exception() << "Cannot write to a GPIO bank of inputs";
+  }
+  m_lines.setValues(word);
+}
+
+std::uint32_t GpiocdevGpioBank::read() const {
+  return static_cast<std::uint32_t>(m_lines.getValues());
+}
+
+} // end of namespace PiHWCtrl
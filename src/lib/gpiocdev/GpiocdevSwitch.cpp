@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file gpiocdev/GpiocdevSwitch.cpp
+ * @author nikoapos
+ */
+
+#include <PiHWCtrl/gpiocdev/GpiocdevSwitch.h>
+
+namespace PiHWCtrl {
+
+GpiocdevSwitch::GpiocdevSwitch(int gpio, int chip)
+        : m_line({gpio}, GpioLineRequest::Direction::OUTPUT,
+                 GpioLineRequest::Edge::NONE, 0, chip) {
+}
+
+void GpiocdevSwitch::set(bool value) {
+  m_line.setValues(value ? 1 : 0);
+  notifyObservers(value);
+}
+
+bool GpiocdevSwitch::isOn() const {
+  return m_line.getValues() & 1;
+}
+
+} // end of namespace PiHWCtrl
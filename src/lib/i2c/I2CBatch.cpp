@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file i2c/I2CBatch.cpp
+ * @author nikoapos
+ */
+
+#include <PiHWCtrl/i2c/I2CBus.h>
+#include <PiHWCtrl/i2c/I2CBatch.h>
+#include <PiHWCtrl/i2c/exceptions.h>
+
+namespace PiHWCtrl {
+
+namespace {
+
+// The maximum number of messages of one transfer
+constexpr std::size_t MAX_MESSAGES = I2CTransport::MAX_MESSAGES;
+
+} // end of anonymous namespace
+
+const std::uint8_t* I2CBatch::View::data() const {
+  return m_batch.get().m_data.data() + m_offset;
+}
+
+I2CBatch::I2CBatch(I2CBus& bus, std::uint8_t address) : m_bus(bus), m_address(address) {
+}
+
+auto I2CBatch::read(std::uint8_t register_address, std::size_t size) -> View {
+  std::size_t offset = m_data.size();
+  m_data.push_back(register_address);
+  m_data.resize(m_data.size() + size);
+  m_operations.push_back(Operation{true, offset, size});
+  return View{*this, offset + 1, size};
+}
+
+void I2CBatch::write(std::uint8_t register_address, const std::uint8_t* data, std::size_t size) {
+  std::size_t offset = m_data.size();
+  m_data.push_back(register_address);
+  m_data.insert(m_data.end(), data, data + size);
+  m_operations.push_back(Operation{false, offset, size});
+}
+
+void I2CBatch::clear() {
+  m_operations.clear();
+  m_data.clear();
+}
+
+std::size_t I2CBatch::messageCount() const {
+  std::size_t count = 0;
+  for (auto& op : m_operations) {
+    count += op.read ? 2 : 1;
+  }
+  return count;
+}
+
+void I2CBatch::submit() {
+  I2CBus& bus = m_bus;
+  
+  // First check that the bus is locked. If it is not means that we are not in
+  // a valid transaction.
+  if (!bus.m_bus_lock.isLocked()) {
+    throw I2CActionOutOfTransaction();
+  }
+  
+  std::uint8_t* data = m_data.data();
+  I2CMessage messages[MAX_MESSAGES];
+  std::size_t count = 0;
+  
+  auto flush = [&]() {
+    if (count == 0) {
+      return;
+    }
+    if (!bus.transfer(messages, count)) {
+      // We report the error for the first register of the failed transfer
+      std::uint8_t* reg = messages[0].data;
+      bool has_reads = false;
+      for (std::size_t i = 0; i < count; ++i) {
+        has_reads = has_reads || messages[i].read;
+      }
+      if (has_reads) {
+        bus.recordReadError();
+        throw I2CReadRegisterException(*reg);
+      }
+      bus.recordWriteError();
+      // A write of only the register address has no value byte to report
+      if (messages[0].size < 2) {
+        throw I2CWriteRegisterException<int>(*reg);
+      }
+      throw I2CWriteRegisterException<int>(*reg, reg[1]);
+    }
+    count = 0;
+  };
+  
+  for (auto& op : m_operations) {
+    // A read needs two messages, which must go in the same transfer
+    std::size_t needed = op.read ? 2 : 1;
+    if (count + needed > MAX_MESSAGES) {
+      flush();
+    }
+    std::uint8_t* reg = data + op.offset;
+    if (op.read) {
+      messages[count++] = I2CMessage{m_address, false, reg, 1};
+      messages[count++] = I2CMessage{m_address, true, reg + 1, op.size};
+      // Some adapters (like the i2c-bcm2835 of the Raspberry Pi) accept a read
+      // only as the last message of a transfer, so each read ends its transfer
+      flush();
+    } else {
+      messages[count++] = I2CMessage{m_address, false, reg, op.size + 1};
+    }
+  }
+  flush();
+}
+
+} // end of namespace PiHWCtrl
@@ -20,59 +20,319 @@
  * @author nikoapos
  */
 
-#include <string>
-#include <fcntl.h> // For open()
-#include <unistd.h> // For close()
-#include <sys/ioctl.h> // For ioctl()
-#include <linux/i2c-dev.h>
+#include <chrono>
+#include <algorithm> // for std::copy
 #include <PiHWCtrl/utils/GpioManager.h>
 #include <PiHWCtrl/i2c/I2CBus.h>
+#include <PiHWCtrl/i2c/LinuxI2CTransport.h>
 #include <PiHWCtrl/i2c/exceptions.h>
 
 namespace PiHWCtrl {
 
 namespace {
 
-constexpr int I2C_ADAPTER = 1;
+constexpr int DEFAULT_ADAPTER = 1;
 constexpr int SDA_GPIO = 2;
 constexpr int SCL_GPIO = 3;
 
-void connectToDevice(int bus_file, int address) {
-  if (ioctl(bus_file, I2C_SLAVE, address) < 0) {
-    throw I2CDeviceConnectionFailure(address);
-  }
-}
+std::mutex registry_mutex;
+std::map<int, std::shared_ptr<I2CBus>> registry;
 
 } // end of anonymous namespace
 
 std::shared_ptr<I2CBus> I2CBus::getSingleton() {
-  static std::shared_ptr<I2CBus> singleton = std::shared_ptr<I2CBus>(new I2CBus{});
-  return singleton;
+  return open(DEFAULT_ADAPTER);
+}
+
+std::shared_ptr<I2CBus> I2CBus::open(int adapter_number) {
+  std::lock_guard<std::mutex> lock {registry_mutex};
+  auto& bus = registry[adapter_number];
+  if (!bus) {
+    // Reserve the GPIOs used for the SDA and SCL so no other object can use them
+    std::unique_ptr<GpioManager::GpioReservation> sda_gpio_reservation;
+    std::unique_ptr<GpioManager::GpioReservation> scl_gpio_reservation;
+    if (adapter_number == DEFAULT_ADAPTER) {
+      sda_gpio_reservation = GpioManager::getSingleton()->reserveGpio(SDA_GPIO);
+      scl_gpio_reservation = GpioManager::getSingleton()->reserveGpio(SCL_GPIO);
+    }
+    std::unique_ptr<I2CTransport> transport = std::make_unique<LinuxI2CTransport>(adapter_number);
+    bus = std::shared_ptr<I2CBus>(new I2CBus{adapter_number, std::move(transport)});
+    bus->m_sda_gpio_reservation = std::move(sda_gpio_reservation);
+    bus->m_scl_gpio_reservation = std::move(scl_gpio_reservation);
+  }
+  return bus;
+}
+
+std::shared_ptr<I2CBus> I2CBus::attach(int adapter_number, std::unique_ptr<I2CTransport> transport) {
+  std::lock_guard<std::mutex> lock {registry_mutex};
+  auto& bus = registry[adapter_number];
+  if (bus) {
+    throw Exception() << "I2C adapter " << adapter_number << " is already open";
+  }
+  bus = std::shared_ptr<I2CBus>(new I2CBus{adapter_number, std::move(transport)});
+  return bus;
+}
+
+I2CBus::I2CBus(int adapter_number, std::unique_ptr<I2CTransport> transport)
+        : m_adapter_number(adapter_number), m_transport(std::move(transport)) {
 }
 
-I2CBus::I2CBus() {
-  // Reserve the GPIOs used for the SDA and SCL so no other object can use them
-  m_sda_gpio_reservation = GpioManager::getSingleton()->reserveGpio(SDA_GPIO);
-  m_scl_gpio_reservation = GpioManager::getSingleton()->reserveGpio(SCL_GPIO);
+I2CBus::~I2CBus() = default;
+
+I2CTransaction I2CBus::startTransaction(std::uint8_t address, I2CBusLock::Priority priority) {
+  auto wait_histogram = getWaitHistogram(address);
+  auto wait_start = std::chrono::steady_clock::now();
+  I2CTransaction transaction {m_bus_lock, priority, *this, address};
+  wait_histogram->record(std::chrono::steady_clock::now() - wait_start);
   
-  // Open the file for using the bus
-  std::string filename = "/dev/i2c-" + std::to_string(I2C_ADAPTER);
-  m_bus_file = open(filename.c_str(), O_RDWR);
-  if (m_bus_file < 0) {
-    throw I2CBusOpenFailure(filename);
+  m_current_counters = nullptr;
+  if (m_instrumentation_enabled.load(std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> lock {m_statistics_mutex};
+    auto& counters = m_device_counters[address];
+    if (!counters) {
+      counters = std::make_shared<DeviceCounters>();
+    }
+    m_current_counters = counters.get();
+    m_current_counters->transactions.fetch_add(1, std::memory_order_relaxed);
+  }
+  m_transport->selectDevice(address);
+  m_address = address;
+  return transaction;
+}
+
+std::future<void> I2CBus::submit(I2CRequest request) {
+  auto promise = std::make_shared<std::promise<void>>();
+  auto future = promise->get_future();
+  submit(std::move(request), [promise](std::exception_ptr error) {
+    if (error) {
+      promise->set_exception(error);
+    } else {
+      promise->set_value();
+    }
+  });
+  return future;
+}
+
+void I2CBus::submit(I2CRequest request, I2CRequestQueue::Callback callback) {
+  std::unique_lock<std::mutex> lock {m_request_queue_mutex};
+  if (!m_request_queue) {
+    m_request_queue.reset(new I2CRequestQueue{*this});
+  }
+  lock.unlock();
+  m_request_queue->submit(std::move(request), std::move(callback));
+}
+
+std::shared_ptr<LatencyHistogram> I2CBus::getWaitHistogram(std::uint8_t address) {
+  std::lock_guard<std::mutex> lock {m_statistics_mutex};
+  auto& histogram = m_wait_histograms[address];
+  if (!histogram) {
+    histogram = std::make_shared<LatencyHistogram>();
+  }
+  return histogram;
+}
+
+void I2CBus::openDeviceFile(std::uint8_t address) {
+  std::lock_guard<I2CBusLock> lock {m_bus_lock};
+  auto linux_transport = dynamic_cast<LinuxI2CTransport*>(m_transport.get());
+  if (linux_transport != nullptr) {
+    linux_transport->openDeviceFile(address);
+  }
+}
+
+std::uint64_t I2CBus::getSavedSlaveIoctls() const {
+  auto linux_transport = dynamic_cast<const LinuxI2CTransport*>(m_transport.get());
+  return (linux_transport != nullptr) ? linux_transport->getSavedSlaveIoctls() : 0;
+}
+
+int I2CBus::getAdapterNumber() const {
+  return m_adapter_number;
+}
+
+void I2CBus::setInstrumentationEnabled(bool enabled) {
+  m_instrumentation_enabled = enabled;
+}
+
+bool I2CBus::isInstrumentationEnabled() const {
+  return m_instrumentation_enabled;
+}
+
+std::vector<std::uint8_t> I2CBus::getInstrumentedDevices() {
+  std::lock_guard<std::mutex> lock {m_statistics_mutex};
+  std::vector<std::uint8_t> addresses;
+  for (auto& pair : m_device_counters) {
+    addresses.push_back(pair.first);
+  }
+  return addresses;
+}
+
+auto I2CBus::getDeviceStatistics(std::uint8_t address) -> DeviceStatistics {
+  DeviceStatistics statistics {};
+  statistics.wait_time = getWaitHistogram(address)->getSnapshot();
+  std::shared_ptr<DeviceCounters> counters;
+  {
+    std::lock_guard<std::mutex> lock {m_statistics_mutex};
+    auto it = m_device_counters.find(address);
+    if (it == m_device_counters.end()) {
+      return statistics;
+    }
+    counters = it->second;
   }
+  statistics.transactions = counters->transactions;
+  statistics.bytes_read = counters->bytes_read;
+  statistics.bytes_written = counters->bytes_written;
+  statistics.read_errors = counters->read_errors;
+  statistics.write_errors = counters->write_errors;
+  statistics.transfer_latency = counters->transfer_latency.getSnapshot();
+  return statistics;
 }
 
-I2CBus::~I2CBus() {
+void I2CBus::resetStatistics() {
+  std::lock_guard<std::mutex> lock {m_statistics_mutex};
+  for (auto& pair : m_wait_histograms) {
+    pair.second->reset();
+  }
+  // The counters might be used by the current transaction, so we reset them
+  // instead of removing them
+  for (auto& pair : m_device_counters) {
+    auto& counters = *pair.second;
+    counters.transactions = 0;
+    counters.bytes_read = 0;
+    counters.bytes_written = 0;
+    counters.read_errors = 0;
+    counters.write_errors = 0;
+    counters.transfer_latency.reset();
+  }
+}
+
+void I2CBus::readRegisterBlock(std::uint8_t register_address, std::uint8_t* buffer, std::size_t size) {
   
-  // Close the bus file
-  close(m_bus_file);
+  // First check that the bus is locked. If it is not means that we are not in
+  // a valid transaction.
+  if (!m_bus_lock.isLocked()) {
+    throw I2CActionOutOfTransaction();
+  }
+  
+  // Write the register address and read the data in a single transfer
+  I2CMessage messages[2] = {
+    {m_address, false, &register_address, 1},
+    {m_address, true, buffer, size}
+  };
+  if (!transfer(messages, 2)) {
+    recordReadError();
+    throw I2CReadRegisterException(register_address);
+  }
 }
 
-I2CTransaction I2CBus::startTransaction(std::uint8_t address) {
-  I2CTransaction transaction {m_bus_mutex};
-  connectToDevice(m_bus_file, address);
-  return transaction;
+std::uint8_t I2CBus::readByteData(std::uint8_t command) {
+  SMBusData data;
+  smbusTransfer(SMBusProtocol::BYTE_DATA, true, command, data);
+  return data[0];
+}
+
+void I2CBus::writeByteData(std::uint8_t command, std::uint8_t value) {
+  SMBusData data;
+  data[0] = value;
+  smbusTransfer(SMBusProtocol::BYTE_DATA, false, command, data);
+}
+
+std::uint16_t I2CBus::readWordData(std::uint8_t command) {
+  SMBusData data;
+  smbusTransfer(SMBusProtocol::WORD_DATA, true, command, data);
+  return le16::decode(data.data());
+}
+
+void I2CBus::writeWordData(std::uint8_t command, std::uint16_t value) {
+  SMBusData data;
+  le16::encode(value, data.data());
+  smbusTransfer(SMBusProtocol::WORD_DATA, false, command, data);
+}
+
+std::uint16_t I2CBus::processCall(std::uint8_t command, std::uint16_t value) {
+  SMBusData data;
+  le16::encode(value, data.data());
+  smbusTransfer(SMBusProtocol::PROC_CALL, true, command, data);
+  return le16::decode(data.data());
+}
+
+std::size_t I2CBus::readBlockData(std::uint8_t command, std::uint8_t* buffer) {
+  SMBusData data;
+  smbusTransfer(SMBusProtocol::BLOCK_DATA, true, command, data);
+  std::copy(data.begin() + 1, data.begin() + 1 + data[0], buffer);
+  return data[0];
+}
+
+void I2CBus::writeBlockData(std::uint8_t command, const std::uint8_t* buffer, std::size_t size) {
+  if (size > SMBUS_BLOCK_MAX) {
+    throw Exception() << "SMBus blocks can have up to " << SMBUS_BLOCK_MAX << " bytes";
+  }
+  SMBusData data;
+  data[0] = size;
+  std::copy(buffer, buffer + size, data.begin() + 1);
+  smbusTransfer(SMBusProtocol::BLOCK_DATA, false, command, data);
+}
+
+void I2CBus::smbusTransfer(SMBusProtocol protocol, bool read, std::uint8_t command, SMBusData& data) {
+  
+  // First check that the bus is locked. If it is not means that we are not in
+  // a valid transaction.
+  if (!m_bus_lock.isLocked()) {
+    throw I2CActionOutOfTransaction();
+  }
+  
+  // The data bytes the protocol writes and reads, which are the words, or the
+  // blocks with their length
+  std::size_t data_size = 0;
+  switch (protocol) {
+    case SMBusProtocol::BYTE_DATA: data_size = 1; break;
+    case SMBusProtocol::WORD_DATA: data_size = 2; break;
+    case SMBusProtocol::PROC_CALL: data_size = 2; break;
+    case SMBusProtocol::BLOCK_DATA: data_size = read ? 0 : data[0] + 1; break;
+  }
+  
+  auto start = std::chrono::steady_clock::now();
+  if (!m_transport->smbusTransfer(m_address, protocol, read, command, data)) {
+    if (read || protocol == SMBusProtocol::PROC_CALL) {
+      recordReadError();
+      throw I2CReadRegisterException(command);
+    }
+    recordWriteError();
+    throw I2CWriteRegisterException<int>(command, data[0]);
+  }
+  
+  if (m_current_counters != nullptr) {
+    m_current_counters->transfer_latency.record(std::chrono::steady_clock::now() - start);
+    std::size_t bytes_read = 0;
+    std::size_t bytes_written = 1;
+    if (protocol == SMBusProtocol::PROC_CALL) {
+      bytes_written += data_size;
+      bytes_read += data_size;
+    } else if (read) {
+      bytes_read += (protocol == SMBusProtocol::BLOCK_DATA) ? data[0] + 1 : data_size;
+    } else {
+      bytes_written += data_size;
+    }
+    m_current_counters->bytes_read.fetch_add(bytes_read, std::memory_order_relaxed);
+    m_current_counters->bytes_written.fetch_add(bytes_written, std::memory_order_relaxed);
+  }
+}
+
+bool I2CBus::transfer(I2CMessage* messages, std::size_t count) {
+  if (m_current_counters == nullptr) {
+    return m_transport->transfer(messages, count);
+  }
+  auto start = std::chrono::steady_clock::now();
+  if (!m_transport->transfer(messages, count)) {
+    return false;
+  }
+  m_current_counters->transfer_latency.record(std::chrono::steady_clock::now() - start);
+  std::size_t bytes_read = 0;
+  std::size_t bytes_written = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    (messages[i].read ? bytes_read : bytes_written) += messages[i].size;
+  }
+  m_current_counters->bytes_read.fetch_add(bytes_read, std::memory_order_relaxed);
+  m_current_counters->bytes_written.fetch_add(bytes_written, std::memory_order_relaxed);
+  return true;
 }
 
 } // end of namespace PiHWCtrl
\ No newline at end of file
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file i2c/I2CBusLock.cpp
+ * @author nikoapos
+ */
+
+#include <PiHWCtrl/i2c/I2CBusLock.h>
+
+namespace PiHWCtrl {
+
+namespace {
+
+constexpr std::size_t REALTIME = static_cast<std::size_t>(I2CBusLock::Priority::REALTIME);
+
+} // end of anonymous namespace
+
+void I2CBusLock::lock(Priority priority) {
+  std::size_t index = static_cast<std::size_t>(priority);
+  std::unique_lock<std::mutex> lock {m_mutex};
+  std::uint64_t ticket = m_next_ticket[index]++;
+  m_condition.wait(lock, [this, index, ticket]() {
+    if (m_locked || m_serving[index] != ticket) {
+      return false;
+    }
+    // The lower priorities wait for all the higher priority waiters
+    for (std::size_t i = REALTIME; i < index; ++i) {
+      if (m_next_ticket[i] != m_serving[i]) {
+        return false;
+      }
+    }
+    return true;
+  });
+  ++m_serving[index];
+  m_locked = true;
+}
+
+void I2CBusLock::unlock() {
+  {
+    std::lock_guard<std::mutex> lock {m_mutex};
+    m_locked = false;
+  }
+  // The waiters check themselves if it is their turn
+  m_condition.notify_all();
+}
+
+bool I2CBusLock::isLocked() const {
+  std::lock_guard<std::mutex> lock {m_mutex};
+  return m_locked;
+}
+
+} // end of namespace PiHWCtrl
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file i2c/I2CRequestQueue.cpp
+ * @author nikoapos
+ */
+
+#include <algorithm> // for std::stable_sort
+#include <vector>
+#include <PiHWCtrl/HWInterfaces/exceptions.h>
+#include <PiHWCtrl/i2c/I2CBus.h>
+#include <PiHWCtrl/i2c/I2CRequestQueue.h>
+
+namespace PiHWCtrl {
+
+I2CRequestQueue::I2CRequestQueue(I2CBus& bus) : m_bus(bus) {
+  m_worker = std::thread {[this]() { workerLoop(); }};
+}
+
+I2CRequestQueue::~I2CRequestQueue() {
+  {
+    std::lock_guard<std::mutex> lock {m_mutex};
+    m_stopping = true;
+  }
+  m_condition.notify_all();
+  m_worker.join();
+  for (auto& pending : m_requests) {
+    if (!pending->callback) {
+      continue;
+    }
+    if (pending->done) {
+      pending->callback(pending->error);
+    } else {
+      pending->callback(std::make_exception_ptr(
+          Exception() << "I2C bus " << m_bus.getAdapterNumber() << " closed before the request finished"));
+    }
+  }
+}
+
+void I2CRequestQueue::submit(I2CRequest request, Callback callback) {
+  auto pending = std::make_shared<Pending>(Pending{std::move(request), std::move(callback),
+                                                   0, Clock::now(), nullptr, false});
+  // A request without stages is already finished
+  pending->done = pending->request.getStages().empty();
+  {
+    std::lock_guard<std::mutex> lock {m_mutex};
+    m_requests.push_back(pending);
+  }
+  m_condition.notify_one();
+}
+
+void I2CRequestQueue::execute(Pending& pending) {
+  auto& stages = pending.request.getStages();
+  try {
+    while (true) {
+      auto next = stages[pending.stage](m_bus);
+      if (!next.repeat) {
+        ++pending.stage;
+      }
+      if (pending.stage == stages.size()) {
+        pending.done = true;
+        return;
+      }
+      // A repeated stage always goes back to the worker loop, even without a
+      // delay, so a stage polling a device which is not ready does not keep
+      // the bus from the other requests
+      if (next.repeat || next.delay > I2CRequest::Duration::zero()) {
+        pending.ready_time = Clock::now() + next.delay;
+        return;
+      }
+    }
+  } catch (...) {
+    pending.error = std::current_exception();
+    pending.done = true;
+  }
+}
+
+void I2CRequestQueue::workerLoop() {
+  std::unique_lock<std::mutex> lock {m_mutex};
+  std::vector<std::shared_ptr<Pending>> ready;
+  std::vector<std::shared_ptr<Pending>> finished;
+  while (!m_stopping) {
+    
+    // Collect the requests which do not wait for a delay
+    ready.clear();
+    auto now = Clock::now();
+    auto wake_time = Clock::time_point::max();
+    for (auto& pending : m_requests) {
+      if (pending->done) {
+        continue;
+      }
+      if (pending->ready_time <= now) {
+        ready.push_back(pending);
+      } else {
+        wake_time = std::min(wake_time, pending->ready_time);
+      }
+    }
+    
+    if (ready.empty()) {
+      // A new request notifies the condition
+      if (wake_time == Clock::time_point::max()) {
+        m_condition.wait(lock);
+      } else {
+        m_condition.wait_until(lock, wake_time);
+      }
+      continue;
+    }
+    
+    // The stages are executed without the queue lock, so new requests can be
+    // submitted meanwhile. Only the worker modifies the requests in the queue.
+    lock.unlock();
+    
+    // Group the stages of each device, with the REALTIME requests first. The
+    // sort is stable, so the requests of a device keep their order.
+    std::stable_sort(ready.begin(), ready.end(),
+        [](const std::shared_ptr<Pending>& a, const std::shared_ptr<Pending>& b) {
+          if (a->request.getPriority() != b->request.getPriority()) {
+            return a->request.getPriority() < b->request.getPriority();
+          }
+          return a->request.getAddress() < b->request.getAddress();
+        });
+    auto group_begin = ready.begin();
+    while (group_begin != ready.end()) {
+      auto address = (*group_begin)->request.getAddress();
+      auto priority = (*group_begin)->request.getPriority();
+      auto group_end = std::find_if(group_begin, ready.end(),
+          [address, priority](const std::shared_ptr<Pending>& pending) {
+            return pending->request.getAddress() != address
+                || pending->request.getPriority() != priority;
+          });
+      try {
+        auto transaction = m_bus.startTransaction(address, priority);
+        for (auto it = group_begin; it != group_end; ++it) {
+          execute(**it);
+        }
+      } catch (...) {
+        // The transaction could not be started, so all the requests fail
+        for (auto it = group_begin; it != group_end; ++it) {
+          (*it)->error = std::current_exception();
+          (*it)->done = true;
+        }
+      }
+      group_begin = group_end;
+    }
+    
+    // Remove the finished requests from the front of the queue, so they are
+    // reported in the order they were submitted
+    lock.lock();
+    finished.clear();
+    while (!m_requests.empty() && m_requests.front()->done) {
+      finished.push_back(m_requests.front());
+      m_requests.pop_front();
+    }
+    lock.unlock();
+    for (auto& pending : finished) {
+      if (pending->callback) {
+        pending->callback(pending->error);
+      }
+    }
+    finished.clear();
+    lock.lock();
+  }
+}
+
+} // end of namespace PiHWCtrl
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file i2c/I2CTransport.cpp
+ * @author nikoapos
+ */
+
+#include <cerrno>
+#include <algorithm> // for std::min
+#include <PiHWCtrl/i2c/I2CTransport.h>
+
+namespace PiHWCtrl {
+
+constexpr std::size_t I2CTransport::MAX_MESSAGES;
+
+bool I2CTransport::smbusTransfer(std::uint8_t address, SMBusProtocol protocol, bool read,
+                                 std::uint8_t command, SMBusData& data) {
+  
+  // The command followed by the data to write
+  std::uint8_t out[SMBUS_BLOCK_MAX + 2];
+  out[0] = command;
+  std::size_t out_size = 1;
+  std::uint8_t* in = data.data();
+  std::size_t in_size = 0;
+  
+  switch (protocol) {
+    case SMBusProtocol::BYTE_DATA:
+    case SMBusProtocol::WORD_DATA: {
+      std::size_t size = (protocol == SMBusProtocol::BYTE_DATA) ? 1 : 2;
+      if (read) {
+        in_size = size;
+      } else {
+        std::copy(data.begin(), data.begin() + size, out + 1);
+        out_size += size;
+      }
+      break;
+    }
+    case SMBusProtocol::PROC_CALL:
+      std::copy(data.begin(), data.begin() + 2, out + 1);
+      out_size += 2;
+      in_size = 2;
+      break;
+    case SMBusProtocol::BLOCK_DATA:
+      if (read) {
+        in_size = SMBUS_BLOCK_MAX + 1;
+      } else {
+        if (data[0] > SMBUS_BLOCK_MAX) {
+          errno = EINVAL;
+          return false;
+        }
+        std::copy(data.begin(), data.begin() + data[0] + 1, out + 1);
+        out_size += data[0] + 1;
+      }
+      break;
+  }
+  
+  I2CMessage messages[2] = {
+    {address, false, out, out_size},
+    {address, true, in, in_size}
+  };
+  if (!transfer(messages, in_size > 0 ? 2 : 1)) {
+    return false;
+  }
+  if (protocol == SMBusProtocol::BLOCK_DATA && read) {
+    data[0] = std::min<std::size_t>(data[0], SMBUS_BLOCK_MAX);
+  }
+  return true;
+}
+
+} // end of namespace PiHWCtrl
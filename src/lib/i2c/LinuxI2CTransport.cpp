@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file i2c/LinuxI2CTransport.cpp
+ * @author nikoapos
+ */
+
+#include <string>
+#include <algorithm> // for std::copy
+#include <fcntl.h> // For open()
+#include <unistd.h> // For close(), read() and write()
+#include <sys/ioctl.h> // For ioctl()
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h> // For i2c_msg, i2c_smbus_data and the I2C_FUNC flags
+#include <PiHWCtrl/i2c/LinuxI2CTransport.h>
+#include <PiHWCtrl/i2c/exceptions.h>
+
+namespace PiHWCtrl {
+
+namespace {
+
+static_assert(I2CTransport::MAX_MESSAGES == I2C_RDWR_IOCTL_MAX_MSGS,
+              "The I2CTransport::MAX_MESSAGES must be the kernel limit");
+
+std::string adapterFilename(int adapter_number) {
+  return "/dev/i2c-" + std::to_string(adapter_number);
+}
+
+static_assert(sizeof(SMBusData) == sizeof(i2c_smbus_data::block),
+              "The SMBusData must have the size of the kernel block");
+
+// Returns the I2C_SMBUS size and the I2C_FUNC flag needed for a protocol
+void smbusProtocolInfo(SMBusProtocol protocol, bool read, int& size, unsigned long& func) {
+  switch (protocol) {
+    case SMBusProtocol::BYTE_DATA:
+      size = I2C_SMBUS_BYTE_DATA;
+      func = read ? I2C_FUNC_SMBUS_READ_BYTE_DATA : I2C_FUNC_SMBUS_WRITE_BYTE_DATA;
+      break;
+    case SMBusProtocol::WORD_DATA:
+      size = I2C_SMBUS_WORD_DATA;
+      func = read ? I2C_FUNC_SMBUS_READ_WORD_DATA : I2C_FUNC_SMBUS_WRITE_WORD_DATA;
+      break;
+    case SMBusProtocol::PROC_CALL:
+      size = I2C_SMBUS_PROC_CALL;
+      func = I2C_FUNC_SMBUS_PROC_CALL;
+      break;
+    case SMBusProtocol::BLOCK_DATA:
+      size = I2C_SMBUS_BLOCK_DATA;
+      func = read ? I2C_FUNC_SMBUS_READ_BLOCK_DATA : I2C_FUNC_SMBUS_WRITE_BLOCK_DATA;
+      break;
+  }
+}
+
+void connectToDevice(int bus_file, int address) {
+  if (ioctl(bus_file, I2C_SLAVE, address) < 0) {
+    throw I2CDeviceConnectionFailure(address);
+  }
+}
+
+} // end of anonymous namespace
+
+LinuxI2CTransport::LinuxI2CTransport(int adapter_number) : m_adapter_number(adapter_number) {
+  // Open the file for using the bus
+  std::string filename = adapterFilename(adapter_number);
+  m_bus_file = open(filename.c_str(), O_RDWR);
+  if (m_bus_file < 0) {
+    throw I2CBusOpenFailure(filename);
+  }
+  m_current_file = m_bus_file;
+  
+  // Get the functionality of the adapter, like if it can do combined
+  // transfers with repeated start or which SMBus protocols it supports
+  if (ioctl(m_bus_file, I2C_FUNCS, &m_funcs) < 0) {
+    m_funcs = 0;
+  }
+}
+
+LinuxI2CTransport::~LinuxI2CTransport() {
+  // Close the bus file and the dedicated files of the devices
+  close(m_bus_file);
+  for (auto& pair : m_device_files) {
+    close(pair.second);
+  }
+}
+
+void LinuxI2CTransport::selectDevice(std::uint8_t address) {
+  auto device_file = m_device_files.find(address);
+  if (device_file != m_device_files.end()) {
+    m_current_file = device_file->second;
+    ++m_saved_slave_ioctls;
+    return;
+  }
+  m_current_file = m_bus_file;
+  if (m_bus_file_address == address) {
+    ++m_saved_slave_ioctls;
+  } else {
+    // If the connection fails we do not know where the file points to
+    m_bus_file_address = -1;
+    connectToDevice(m_bus_file, address);
+    m_bus_file_address = address;
+  }
+}
+
+bool LinuxI2CTransport::transfer(I2CMessage* messages, std::size_t count) {
+  
+  if (m_funcs & I2C_FUNC_I2C) {
+    i2c_msg kernel_messages[MAX_MESSAGES];
+    for (std::size_t i = 0; i < count; ++i) {
+      kernel_messages[i].addr = messages[i].address;
+      kernel_messages[i].flags = messages[i].read ? I2C_M_RD : 0;
+      kernel_messages[i].len = messages[i].size;
+      kernel_messages[i].buf = messages[i].data;
+    }
+    i2c_rdwr_ioctl_data data;
+    data.msgs = kernel_messages;
+    data.nmsgs = count;
+    return ioctl(m_current_file, I2C_RDWR, &data) == static_cast<int>(count);
+  }
+  
+  // The messages are for the selected device, so we perform them one by one
+  for (std::size_t i = 0; i < count; ++i) {
+    auto& message = messages[i];
+    ssize_t result = message.read ? read(m_current_file, message.data, message.size)
+                                  : write(m_current_file, message.data, message.size);
+    if (result != static_cast<ssize_t>(message.size)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool LinuxI2CTransport::smbusTransfer(std::uint8_t address, SMBusProtocol protocol, bool read,
+                                      std::uint8_t command, SMBusData& data) {
+  int size;
+  unsigned long func;
+  smbusProtocolInfo(protocol, read, size, func);
+  if (!(m_funcs & func)) {
+    // The adapter does not support the protocol so we use I2C messages
+    return I2CTransport::smbusTransfer(address, protocol, read, command, data);
+  }
+  
+  // The PROC_CALL is a write for the kernel, even if it returns data
+  bool kernel_read = read && protocol != SMBusProtocol::PROC_CALL;
+  i2c_smbus_data kernel_data;
+  if (protocol == SMBusProtocol::WORD_DATA || protocol == SMBusProtocol::PROC_CALL) {
+    kernel_data.word = data[0] | (data[1] << 8);
+  } else {
+    std::copy(data.begin(), data.end(), kernel_data.block);
+  }
+  
+  i2c_smbus_ioctl_data args;
+  args.read_write = kernel_read ? I2C_SMBUS_READ : I2C_SMBUS_WRITE;
+  args.command = command;
+  args.size = size;
+  args.data = &kernel_data;
+  if (ioctl(m_current_file, I2C_SMBUS, &args) < 0) {
+    return false;
+  }
+  
+  if (protocol == SMBusProtocol::WORD_DATA || protocol == SMBusProtocol::PROC_CALL) {
+    data[0] = kernel_data.word & 0xFF;
+    data[1] = kernel_data.word >> 8;
+  } else {
+    std::copy(kernel_data.block, kernel_data.block + data.size(), data.begin());
+  }
+  return true;
+}
+
+void LinuxI2CTransport::openDeviceFile(std::uint8_t address) {
+  if (m_device_files.count(address) > 0) {
+    return;
+  }
+  std::string filename = adapterFilename(m_adapter_number);
+  int file = open(filename.c_str(), O_RDWR);
+  if (file < 0) {
+    throw I2CBusOpenFailure(filename);
+  }
+  try {
+    connectToDevice(file, address);
+  } catch (...) {
+    close(file);
+    throw;
+  }
+  m_device_files[address] = file;
+}
+
+std::uint64_t LinuxI2CTransport::getSavedSlaveIoctls() const {
+  return m_saved_slave_ioctls;
+}
+
+} // end of namespace PiHWCtrl
@@ -0,0 +1,262 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file i2c/SimulatedI2CDevices.cpp
+ * @author nikoapos
+ */
+
+#include <cmath>
+#include <algorithm> // for std::min and std::max
+#include <PiHWCtrl/i2c/SimulatedI2CDevices.h>
+
+namespace PiHWCtrl {
+
+namespace {
+
+// ADS1115 registers and config bits
+constexpr std::uint8_t ADS1115_REG_CONVERSION = 0x00;
+constexpr std::uint8_t ADS1115_REG_CONFIG = 0x01;
+constexpr std::uint8_t ADS1115_REG_LO_THRESH = 0x02;
+constexpr std::uint8_t ADS1115_REG_HI_THRESH = 0x03;
+constexpr std::uint16_t ADS1115_OS = 0x8000;
+constexpr std::uint16_t ADS1115_MODE_SINGLE_SHOT = 0x0100;
+
+// The full scale of each gain setting of the ADS1115
+constexpr std::array<float, 8> ADS1115_FULL_SCALE {{6.144, 4.096, 2.048, 1.024, 0.512,
+                                                     0.256, 0.256, 0.256}};
+
+// BMP180 registers and commands
+constexpr std::uint8_t BMP180_REG_CALIBRATION = 0xAA;
+constexpr std::uint8_t BMP180_REG_CHIP_ID = 0xD0;
+constexpr std::uint8_t BMP180_REG_CONTROL = 0xF4;
+constexpr std::uint8_t BMP180_REG_OUT = 0xF6;
+constexpr std::uint8_t BMP180_CMD_TEMPERATURE = 0x2E;
+constexpr std::uint8_t BMP180_CMD_PRESSURE = 0x34;
+constexpr std::uint8_t BMP180_START_CONVERSION = 0x20;
+
+// The calibration coefficients of the example of the BMP180 datasheet (AC1 to
+// MD, where AC4, AC5 and AC6 are unsigned)
+constexpr std::array<int, 11> BMP180_CALIBRATION {{408, -72, -14383, 32741, 32757, 23153,
+                                                   6190, 4, -32768, -8711, 2868}};
+
+// PCA9685 registers
+constexpr std::uint8_t PCA9685_REG_MODE1 = 0x00;
+constexpr std::uint8_t PCA9685_REG_MODE2 = 0x01;
+constexpr std::uint8_t PCA9685_REG_LED_ON = 0x06;
+constexpr std::uint8_t PCA9685_REG_ALL_LED_ON = 0xFA;
+constexpr std::uint8_t PCA9685_REG_ALL_LED_OFF_H = 0xFD;
+constexpr std::uint8_t PCA9685_REG_PRE_SCALE = 0xFE;
+constexpr std::uint8_t PCA9685_AUTO_INCREMENT = 0x20;
+constexpr std::uint8_t PCA9685_FULL = 0x10;
+constexpr int PCA9685_CHANNELS = 16;
+
+} // end of anonymous namespace
+
+bool SimulatedRegisterMap::write(const std::uint8_t* data, std::size_t size) {
+  std::lock_guard<std::mutex> lock {m_mutex};
+  if (size == 0) {
+    return true;
+  }
+  m_pointer = data[0];
+  for (std::size_t i = 1; i < size; ++i) {
+    std::uint8_t reg = m_pointer;
+    m_registers[reg] = data[i];
+    registerWritten(reg, data[i]);
+    if (autoIncrement()) {
+      ++m_pointer;
+    }
+  }
+  return true;
+}
+
+bool SimulatedRegisterMap::read(std::uint8_t* data, std::size_t size) {
+  std::lock_guard<std::mutex> lock {m_mutex};
+  for (std::size_t i = 0; i < size; ++i) {
+    data[i] = m_registers[m_pointer];
+    if (autoIncrement()) {
+      ++m_pointer;
+    }
+  }
+  return true;
+}
+
+std::uint8_t SimulatedRegisterMap::getRegister(std::uint8_t reg) const {
+  std::lock_guard<std::mutex> lock {m_mutex};
+  return m_registers[reg];
+}
+
+void SimulatedRegisterMap::setRegister(std::uint8_t reg, std::uint8_t value) {
+  std::lock_guard<std::mutex> lock {m_mutex};
+  m_registers[reg] = value;
+}
+
+void SimulatedRegisterMap::registerWritten(std::uint8_t, std::uint8_t) {
+}
+
+bool SimulatedRegisterMap::autoIncrement() const {
+  return true;
+}
+
+bool SimulatedADS1115::write(const std::uint8_t* data, std::size_t size) {
+  std::lock_guard<std::mutex> lock {m_mutex};
+  if (size == 0) {
+    return true;
+  }
+  m_pointer = data[0] & 0x03;
+  // Writing less than two bytes only sets the pointer
+  if (size < 3) {
+    return true;
+  }
+  std::uint16_t value = (data[1] << 8) | data[2];
+  switch (m_pointer) {
+    case ADS1115_REG_CONFIG:
+      m_config = value & ~ADS1115_OS;
+      // The single shot conversions complete immediately
+      if ((value & ADS1115_OS) && (value & ADS1115_MODE_SINGLE_SHOT)) {
+        m_conversion = convert();
+      }
+      break;
+    case ADS1115_REG_LO_THRESH:
+      m_lo_thresh = value;
+      break;
+    case ADS1115_REG_HI_THRESH:
+      m_hi_thresh = value;
+      break;
+  }
+  return true;
+}
+
+bool SimulatedADS1115::read(std::uint8_t* data, std::size_t size) {
+  std::lock_guard<std::mutex> lock {m_mutex};
+  bool single_shot = m_config & ADS1115_MODE_SINGLE_SHOT;
+  std::uint16_t value = 0;
+  switch (m_pointer) {
+    case ADS1115_REG_CONVERSION:
+      value = single_shot ? m_conversion : convert();
+      break;
+    case ADS1115_REG_CONFIG:
+      // In single shot mode the device is never busy
+      value = single_shot ? (m_config | ADS1115_OS) : m_config;
+      break;
+    case ADS1115_REG_LO_THRESH:
+      value = m_lo_thresh;
+      break;
+    case ADS1115_REG_HI_THRESH:
+      value = m_hi_thresh;
+      break;
+  }
+  // The device repeats the register for reads longer than two bytes
+  for (std::size_t i = 0; i < size; ++i) {
+    data[i] = (i % 2 == 0) ? (value >> 8) : (value & 0xFF);
+  }
+  return true;
+}
+
+void SimulatedADS1115::setInputVoltage(int input, float voltage) {
+  std::lock_guard<std::mutex> lock {m_mutex};
+  m_voltages.at(input) = voltage;
+}
+
+std::uint16_t SimulatedADS1115::getConfig() const {
+  std::lock_guard<std::mutex> lock {m_mutex};
+  return m_config;
+}
+
+std::int16_t SimulatedADS1115::convert() const {
+  int mux = (m_config >> 12) & 0x07;
+  float voltage = 0;
+  switch (mux) {
+    case 0: voltage = m_voltages[0] - m_voltages[1]; break;
+    case 1: voltage = m_voltages[0] - m_voltages[3]; break;
+    case 2: voltage = m_voltages[1] - m_voltages[3]; break;
+    case 3: voltage = m_voltages[2] - m_voltages[3]; break;
+    default: voltage = m_voltages[mux - 4];
+  }
+  float full_scale = ADS1115_FULL_SCALE[(m_config >> 9) & 0x07];
+  long code = std::lround(voltage / full_scale * 32768);
+  return std::max(-32768l, std::min(32767l, code));
+}
+
+SimulatedBMP180::SimulatedBMP180() {
+  m_registers[BMP180_REG_CHIP_ID] = 0x55;
+  for (std::size_t i = 0; i < BMP180_CALIBRATION.size(); ++i) {
+    std::uint16_t word = static_cast<std::uint16_t>(BMP180_CALIBRATION[i]);
+    m_registers[BMP180_REG_CALIBRATION + 2 * i] = word >> 8;
+    m_registers[BMP180_REG_CALIBRATION + 2 * i + 1] = word & 0xFF;
+  }
+}
+
+void SimulatedBMP180::setUncompensatedValues(std::uint16_t temperature, std::uint32_t pressure) {
+  std::lock_guard<std::mutex> lock {m_mutex};
+  m_temperature = temperature;
+  m_pressure = pressure;
+}
+
+void SimulatedBMP180::registerWritten(std::uint8_t reg, std::uint8_t value) {
+  if (reg != BMP180_REG_CONTROL) {
+    return;
+  }
+  if (value == BMP180_CMD_TEMPERATURE) {
+    m_registers[BMP180_REG_OUT] = m_temperature >> 8;
+    m_registers[BMP180_REG_OUT + 1] = m_temperature & 0xFF;
+  } else if ((value & 0x3F) == BMP180_CMD_PRESSURE) {
+    // The pressure is left aligned, based on the oversampling
+    int oss = value >> 6;
+    std::uint32_t out = m_pressure << (8 - oss);
+    m_registers[BMP180_REG_OUT] = (out >> 16) & 0xFF;
+    m_registers[BMP180_REG_OUT + 1] = (out >> 8) & 0xFF;
+    m_registers[BMP180_REG_OUT + 2] = out & 0xFF;
+  }
+  // The conversion is already done
+  m_registers[BMP180_REG_CONTROL] = value & ~BMP180_START_CONVERSION;
+}
+
+SimulatedPCA9685::SimulatedPCA9685() {
+  m_registers[PCA9685_REG_MODE1] = 0x11;
+  m_registers[PCA9685_REG_MODE2] = 0x04;
+  m_registers[PCA9685_REG_PRE_SCALE] = 0x1E;
+  for (int channel = 0; channel < PCA9685_CHANNELS; ++channel) {
+    m_registers[PCA9685_REG_LED_ON + 4 * channel + 3] = PCA9685_FULL;
+  }
+}
+
+std::uint16_t SimulatedPCA9685::getLedOn(int channel) const {
+  std::lock_guard<std::mutex> lock {m_mutex};
+  std::uint8_t reg = PCA9685_REG_LED_ON + 4 * channel;
+  return m_registers[reg] | (m_registers[reg + 1] << 8);
+}
+
+std::uint16_t SimulatedPCA9685::getLedOff(int channel) const {
+  std::lock_guard<std::mutex> lock {m_mutex};
+  std::uint8_t reg = PCA9685_REG_LED_ON + 4 * channel + 2;
+  return m_registers[reg] | (m_registers[reg + 1] << 8);
+}
+
+void SimulatedPCA9685::registerWritten(std::uint8_t reg, std::uint8_t value) {
+  if (reg >= PCA9685_REG_ALL_LED_ON && reg <= PCA9685_REG_ALL_LED_OFF_H) {
+    for (int channel = 0; channel < PCA9685_CHANNELS; ++channel) {
+      m_registers[PCA9685_REG_LED_ON + 4 * channel + (reg - PCA9685_REG_ALL_LED_ON)] = value;
+    }
+  }
+}
+
+bool SimulatedPCA9685::autoIncrement() const {
+  return m_registers[PCA9685_REG_MODE1] & PCA9685_AUTO_INCREMENT;
+}
+
+} // end of namespace PiHWCtrl
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file i2c/SimulatedI2CTransport.cpp
+ * @author nikoapos
+ */
+
+#include <cerrno>
+#include <chrono>
+#include <thread>
+#include <PiHWCtrl/i2c/SimulatedI2CTransport.h>
+
+namespace PiHWCtrl {
+
+namespace {
+
+// The bits of a byte (eight data bits and the ACK) and of a start or stop
+constexpr std::size_t BYTE_CYCLES = 9;
+constexpr std::size_t CONDITION_CYCLES = 1;
+
+// Below this time we spin instead of sleeping, for better accuracy
+constexpr std::chrono::microseconds MIN_SLEEP {100};
+
+// Waits until the given time
+void waitUntil(std::chrono::steady_clock::time_point time) {
+  auto now = std::chrono::steady_clock::now();
+  if (time - now > MIN_SLEEP) {
+    std::this_thread::sleep_until(time - MIN_SLEEP);
+  }
+  while (std::chrono::steady_clock::now() < time) {
+    std::this_thread::yield();
+  }
+}
+
+} // end of anonymous namespace
+
+constexpr unsigned int SimulatedI2CTransport::STANDARD_MODE;
+constexpr unsigned int SimulatedI2CTransport::FAST_MODE;
+constexpr unsigned int SimulatedI2CTransport::FAST_MODE_PLUS;
+
+SimulatedI2CTransport::SimulatedI2CTransport(unsigned int bus_frequency)
+        : m_bus_frequency(bus_frequency) {
+}
+
+void SimulatedI2CTransport::addDevice(std::uint8_t address, std::shared_ptr<SimulatedI2CDevice> device) {
+  m_devices[address] = device;
+}
+
+void SimulatedI2CTransport::selectDevice(std::uint8_t) {
+}
+
+bool SimulatedI2CTransport::transfer(I2CMessage* messages, std::size_t count) {
+  auto start = std::chrono::steady_clock::now();
+  
+  // Each message starts with a (repeated) start and the address byte and the
+  // transfer ends with a stop
+  std::size_t cycles = CONDITION_CYCLES;
+  bool success = true;
+  for (std::size_t i = 0; i < count && success; ++i) {
+    auto& message = messages[i];
+    cycles += CONDITION_CYCLES + BYTE_CYCLES;
+    auto device = m_devices.find(message.address);
+    if (device == m_devices.end()) {
+      success = false;
+      break;
+    }
+    success = message.read ? device->second->read(message.data, message.size)
+                           : device->second->write(message.data, message.size);
+    if (success) {
+      cycles += BYTE_CYCLES * message.size;
+    }
+  }
+  
+  if (m_bus_frequency > 0) {
+    waitUntil(start + std::chrono::nanoseconds{cycles * 1000000000ull / m_bus_frequency});
+  }
+  
+  if (!success) {
+    errno = EREMOTEIO;
+  }
+  return success;
+}
+
+} // end of namespace PiHWCtrl
@@ -182,40 +182,67 @@ std::map<ADS1115::DataRate, DataRateInfo> data_rate_map {
 
 std::mutex instance_exists_mutex;
 
-std::map<std::uint8_t, bool> instance_exist_map {
-  {ADDRESS_GND, false},
-  {ADDRESS_VDD, false},
-  {ADDRESS_SDA, false},
-  {ADDRESS_SCL, false}
+// The key is the I2C adapter number and the address of the device
+std::map<std::pair<int, std::uint8_t>, bool> instance_exist_map {
 };
 
 std::uint16_t addCmd(std::uint16_t reg, std::uint16_t mask, std::uint16_t command) {
   return ((reg & ~mask) & 0xFFFF) | command;
 }
 
+// The thresholds which make the ALERT/RDY pin a conversion ready signal, and
+// the default ones of the device, which disable it
+constexpr std::uint16_t RDY_HI_THRESH = 0x8000;
+constexpr std::uint16_t RDY_LO_THRESH = 0x0000;
+constexpr std::uint16_t DEFAULT_HI_THRESH = 0x7FFF;
+constexpr std::uint16_t DEFAULT_LO_THRESH = 0x8000;
+
+// Sends the command triggering a single conversion of the given input with the
+// given gain. The bus must be in a transaction with the device.
+void beginConversion(I2CBus& bus, ADS1115::Input input, ADS1115::Gain gain) {
+  std::uint16_t cmd = bus.read<be16>(REG_CONFIG);
+  cmd = addCmd(cmd, CMD_MUX_MASK, input_map.at(input).command);
+  cmd = addCmd(cmd, CMD_GAIN_MASK, gain_map.at(gain).command);
+  cmd = addCmd(cmd, CMD_CONV_MASK, CMD_CONV_BEGIN_SINGLE);
+  bus.write<be16>(REG_CONFIG, cmd);
+}
+
+// Returns the gain the automatic gain mode uses for the next conversion, which
+// is the given gain if the voltage is in the [45%, 90%] of its full scale
+ADS1115::Gain adjustGain(ADS1115::Gain gain, float voltage) {
+  auto& gain_info = gain_map.at(gain);
+  if (std::abs(voltage) < gain_info.full_scale * 0.45) {
+    return gain_info.next;
+  }
+  if (std::abs(voltage) > gain_info.full_scale * 0.9) {
+    return gain_info.previous;
+  }
+  return gain;
+}
+
 } // end of anonymous namespace
 
-std::unique_ptr<ADS1115> ADS1115::factory(AddressPin addr, DataRate data_rate) {
-  return std::unique_ptr<ADS1115>{new ADS1115{addr, data_rate}};
+std::unique_ptr<ADS1115> ADS1115::factory(AddressPin addr, DataRate data_rate, int i2c_adapter) {
+  return std::unique_ptr<ADS1115>{new ADS1115{addr, data_rate, i2c_adapter}};
 }
 
-ADS1115::ADS1115(AddressPin addr, DataRate data_rate)
-        : m_addr(address_map.at(addr).address), m_data_rate(data_rate) {
+ADS1115::ADS1115(AddressPin addr, DataRate data_rate, int i2c_adapter)
+        : m_bus(I2CBus::open(i2c_adapter)), m_addr(address_map.at(addr).address),
+          m_data_rate(data_rate) {
   
   // Check that there is no other instance controlling the device
   std::unique_lock<std::mutex> lock {instance_exists_mutex};
-  if (instance_exist_map.at(m_addr)) {
+  // This will create a new entry with false if the device was never used
+  bool& instance_exists = instance_exist_map[{i2c_adapter, m_addr}];
+  if (instance_exists) {
     throw ModuleAlreadyInUse("ADS1115-"+address_map.at(addr).name);
   } else {
-    instance_exist_map.at(m_addr) = true;
+    instance_exists = true;
   }
   lock.unlock();
   
-  // Get the I2C bus
-  auto bus = I2CBus::getSingleton();
-  
   // Start a transaction that will lock the I2C bus from others until we are done
-  auto transaction = bus->startTransaction(m_addr);
+  auto transaction = m_bus->startTransaction(m_addr);
   
   // We construct the command to initialize the ADS1115
   std::uint16_t cmd = 0x0000;
@@ -225,6 +252,9 @@ ADS1115::ADS1115(AddressPin addr, DataRate data_rate)
   for (auto& pair : input_map) {
     m_input_gain_map[pair.first] = ADS1115::Gain::G_2;
     m_input_auto_gain_flag_map[pair.first] = true;
+    // The observables of all the inputs are created here, so the map is never
+    // modified while the measuring thread iterates it
+    m_input_observable_map[pair.first];
   }
   cmd |= CMD_GAIN_2;
   
@@ -241,16 +271,66 @@ ADS1115::ADS1115(AddressPin addr, DataRate data_rate)
   cmd |= CMD_COMP_POL_ACTIVE_LOW;
   cmd |= CMD_COMP_LAT_DISABLE;
   cmd |= CMD_COMP_QUE_DISABLE;
-  bus->writeRegister(REG_CONFIG, cmd, true);
+  m_bus->write<be16>(REG_CONFIG, cmd);
 
 }
 
+class ADS1115::ReadyObserver : public Observer<bool> {
+  
+public:
+  
+  ReadyObserver(ADS1115& ads1115, Input input)
+          : m_ads1115(ads1115), m_input(input),
+            m_lsb_voltage(gain_map.at(ads1115.m_input_gain_map.at(input)).full_scale / 0x7FFF) {
+  }
+  
+  // Every notification means a conversion is ready, whatever its value. The
+  // RDY pulse lasts only a few microseconds, so the inputs which read the level
+  // of the pin after they are woken up would report it as false.
+  void event(const bool&) override {
+    // The event can come after the observer was removed, from a notification
+    // which had already started, so it is ignored if it is not active
+    std::lock_guard<std::mutex> lock {m_mutex};
+    if (!m_active) {
+      return;
+    }
+    std::int16_t value;
+    {
+      // The next conversion completes in one data rate period, so the read
+      // should not wait behind the background transactions
+      auto transaction = m_ads1115.m_bus->startTransaction(m_ads1115.m_addr,
+                                                           I2CBusLock::Priority::REALTIME);
+      value = static_cast<std::int16_t>(m_ads1115.m_bus->read<be16>(REG_CONVERSION));
+    }
+    m_ads1115.m_input_observable_map.at(m_input).createEvent(m_lsb_voltage * value);
+  }
+  
+  // Waits for the running event (if any) and stops reading the conversions
+  void deactivate() {
+    std::lock_guard<std::mutex> lock {m_mutex};
+    m_active = false;
+  }
+  
+private:
+  
+  ADS1115& m_ads1115;
+  Input m_input;
+  float m_lsb_voltage;
+  std::mutex m_mutex;
+  bool m_active = true;
+  
+};
+
 ADS1115::~ADS1115() {
-  // Stop any threads generating events for the ADS1115
-  stop();
+  // Stop any threads generating events for the ADS1115. If returning the
+  // device to single shot mode fails there is nothing more we can do.
+  try {
+    stop();
+  } catch (...) {
+  }
   // Release the instance_exists flag so new classes can be created
   std::lock_guard<std::mutex> lock {instance_exists_mutex};
-  instance_exist_map.at(m_addr) = false;
+  instance_exist_map.at({m_bus->getAdapterNumber(), m_addr}) = false;
 }
 
 void ADS1115::setGain(Input input, Gain gain) {
@@ -270,10 +350,6 @@ float ADS1115::readConversion(Input input) {
   
   std::lock_guard<std::mutex> lock {m_mutex};
 
-  // Get the I2C bus
-  auto bus = I2CBus::getSingleton();
-  
-  
   // We read the input in a loop, which is repeated when we are in auto gain
   // mode to adjust the gain automatically.
   float voltage;
@@ -282,9 +358,9 @@ float ADS1115::readConversion(Input input) {
     // Send the command for triggering the measurement. We do this in a scope to
     // don't block the I2C bus while waiting for the measurement to be done. 
     {
-      auto transaction = bus->startTransaction(m_addr);
+      auto transaction = m_bus->startTransaction(m_addr);
       // Read the current config register
-      std::uint16_t cmd = bus->readRegister<std::uint16_t>(REG_CONFIG);
+      std::uint16_t cmd = m_bus->read<be16>(REG_CONFIG);
       // Update the input to read
       cmd = addCmd(cmd, CMD_MUX_MASK, input_map.at(input).command);
       // Set the gain based on the input requested
@@ -292,7 +368,7 @@ float ADS1115::readConversion(Input input) {
       // Set the bit for triggering the single conversion
       cmd = addCmd(cmd, CMD_CONV_MASK, CMD_CONV_BEGIN_SINGLE);
       // Send the command
-      bus->writeRegister(REG_CONFIG, cmd, true);
+      m_bus->write<be16>(REG_CONFIG, cmd);
     }
 
     // Now we sleep according the data rate, until the conversion finishes
@@ -301,16 +377,18 @@ float ADS1115::readConversion(Input input) {
     // Wait until the conversion bit of the config register indicates that the
     // measurement is done
     {
-      auto transaction = bus->startTransaction(m_addr);
-      for (std::uint16_t conf = 0x0000; conf & CMD_CONV_MASK == 0; conf=bus->readRegister<std::int16_t>(REG_CONFIG)) {
+      auto transaction = m_bus->startTransaction(m_addr);
+      std::uint16_t conf = m_bus->read<be16>(REG_CONFIG);
+      while ((conf & CMD_CONV_MASK) == 0) {
+        conf = m_bus->read<be16>(REG_CONFIG);
       }
     }
 
     // Read the conversion register
     std::int16_t value;
     {
-      auto transaction = bus->startTransaction(m_addr);
-      value = bus->readRegister<std::int16_t>(REG_CONVERSION);
+      auto transaction = m_bus->startTransaction(m_addr);
+      value = static_cast<std::int16_t>(m_bus->read<be16>(REG_CONVERSION));
     }
 
     // Convert the value to voltage, according the gain and the full scale
@@ -338,6 +416,67 @@ float ADS1115::readConversion(Input input) {
   
 } // end of readConversion()
 
+std::future<float> ADS1115::submitConversion(Input input) {
+  // First check that we are in single shot mode
+  if (m_mode == Mode::CONTINUOUS) {
+    throw InvalidState() << "ADS1115: cannot call submitConversion() when in CONTINUOUS mode";
+  }
+  
+  // The state of the conversion, shared by the stages of the request. The
+  // stages run with the bus locked, so they must not lock the m_mutex, which
+  // the readConversion() keeps while waiting for the bus.
+  struct State {
+    Gain gain;
+    bool auto_gain;
+    float voltage;
+  };
+  auto state = std::make_shared<State>();
+  {
+    std::lock_guard<std::mutex> lock {m_mutex};
+    state->gain = m_input_gain_map.at(input);
+    state->auto_gain = m_input_auto_gain_flag_map.at(input);
+  }
+  auto wait_time = data_rate_map.at(m_data_rate).wait_time;
+  
+  I2CRequest request {m_addr};
+  request.then([state, input, wait_time](I2CBus& bus) {
+    beginConversion(bus, input, state->gain);
+    return I2CRequest::proceed(wait_time);
+  });
+  request.then([state, input, wait_time](I2CBus& bus) {
+    // The conversion bit of the config register is set when it is done
+    if ((bus.read<be16>(REG_CONFIG) & CMD_CONV_MASK) == 0) {
+      return I2CRequest::repeat(wait_time / 8);
+    }
+    auto value = static_cast<std::int16_t>(bus.read<be16>(REG_CONVERSION));
+    state->voltage = (gain_map.at(state->gain).full_scale / 0x7FFF) * value;
+    if (state->auto_gain) {
+      auto gain = adjustGain(state->gain, state->voltage);
+      if (gain != state->gain) {
+        state->gain = gain;
+        beginConversion(bus, input, gain);
+        return I2CRequest::repeat(wait_time);
+      }
+    }
+    return I2CRequest::proceed();
+  });
+  
+  auto promise = std::make_shared<std::promise<float>>();
+  auto future = promise->get_future();
+  m_bus->submit(std::move(request), [this, input, state, promise](std::exception_ptr error) {
+    if (error) {
+      promise->set_exception(error);
+      return;
+    }
+    if (state->auto_gain) {
+      std::lock_guard<std::mutex> lock {m_mutex};
+      m_input_gain_map.at(input) = state->gain;
+    }
+    promise->set_value(state->voltage);
+  });
+  return future;
+}
+
 std::unique_ptr<AnalogInput<float>> ADS1115::conversionAnalogInput(Input input) {
   return std::make_unique<FunctionAnalogInput<float>>(
     [this, input] () { return this->readConversion(input); }
@@ -345,50 +484,103 @@ std::unique_ptr<AnalogInput<float>> ADS1115::conversionAnalogInput(Input input)
 }
 
 void ADS1115::addConversionObserver(Input input, std::shared_ptr<Observer<float>> observer) {
-  std::lock_guard<std::mutex> lock {m_mutex};
-  // We use the [] and not the at() method so the observable will be created the
-  // first time an observer is registered for this input
-  m_input_observable_map[input].addObserver(observer);
+  m_input_observable_map.at(input).addObserver(observer);
 }
 
-void ADS1115::start(int power_down_ms) {
+void ADS1115::start(int period_ms) {
   // First check that we are in single shot mode
   if (m_mode == Mode::CONTINUOUS) {
     throw InvalidState() << "ADS1115: cannot call start() when in CONTINUOUS mode";
   }
   
-  if (m_observing) {
+  if (m_worker.isRunning()) {
     throw Exception() << "ADS1115 already started";
   }
-  m_observing = true;
-
-  auto measurement_task = [this, power_down_ms]() {
-    while (m_observing) {
-      for (auto& pair : m_input_observable_map) {
-        float value = readConversion(pair.first);
-        std::unique_lock<std::mutex> lock {m_mutex};
-        pair.second.createEvent(value);
-        lock.unlock();
+
+  auto measurement_task = [this]() {
+    for (auto& pair : m_input_observable_map) {
+      // We measure only the inputs somebody is interested in
+      if (!pair.second.hasObservers()) {
+        continue;
+      }
+      // Do not start a new conversion if we are asked to stop
+      if (m_worker.stopRequested()) {
+        return;
       }
-      std::this_thread::sleep_for(std::chrono::milliseconds(power_down_ms));
+      float value = readConversion(pair.first);
+      pair.second.createEvent(value);
     }
-    m_observing = true;
   };
   
-  std::thread t {measurement_task};
-  t.detach();
+  m_worker.start(measurement_task, std::chrono::milliseconds(period_ms));
+}
+
+std::shared_ptr<PeriodStatistics> ADS1115::getStatistics() const {
+  return m_worker.getStatistics();
+}
+
+void ADS1115::startContinuous(Input input, Observable<bool>& alert_rdy) {
+  if (m_mode == Mode::CONTINUOUS) {
+    throw InvalidState() << "ADS1115: cannot call startContinuous() when in CONTINUOUS mode";
+  }
+  if (m_worker.isRunning()) {
+    throw InvalidState() << "ADS1115: cannot call startContinuous() while start() is running";
+  }
+  
+  std::lock_guard<std::mutex> lock {m_mutex};
+  
+  // Start listening for the ALERT/RDY pin before the first conversion
+  m_ready_observer = std::make_shared<ReadyObserver>(*this, input);
+  m_ready_subscription = alert_rdy.subscribe(m_ready_observer);
+  m_mode = Mode::CONTINUOUS;
+  
+  try {
+    auto transaction = m_bus->startTransaction(m_addr);
+    m_bus->write<be16>(REG_HI_THRESH, RDY_HI_THRESH);
+    m_bus->write<be16>(REG_LO_THRESH, RDY_LO_THRESH);
+    std::uint16_t cmd = m_bus->read<be16>(REG_CONFIG);
+    cmd = addCmd(cmd, CMD_MUX_MASK, input_map.at(input).command);
+    cmd = addCmd(cmd, CMD_GAIN_MASK, gain_map.at(m_input_gain_map.at(input)).command);
+    cmd = addCmd(cmd, CMD_COMP_MODE_MASK, CMD_COMP_MODE_TRADITIONAL);
+    cmd = addCmd(cmd, CMD_COMP_POL_ACTIVE_MASK, CMD_COMP_POL_ACTIVE_HIGH);
+    cmd = addCmd(cmd, CMD_COMP_LAT_MASK, CMD_COMP_LAT_DISABLE);
+    cmd = addCmd(cmd, CMD_COMP_QUE_MASK, CMD_COMP_QUE_1);
+    cmd = addCmd(cmd, CMD_MODE_MASK, CMD_MODE_CONTINUOUS);
+    m_bus->write<be16>(REG_CONFIG, cmd);
+  } catch (...) {
+    m_ready_observer->deactivate();
+    m_ready_subscription.reset();
+    m_ready_observer.reset();
+    m_mode = Mode::SINGLE_SHOT;
+    throw;
+  }
 }
 
 void ADS1115::stop() {
-  if (m_observing) {
-    // This will trigger the measuring thread to stop
-    m_observing = false;
-    // We have to wait until the thread signals that it stopped
-    while (!m_observing) {
-    }
-    // Now we can set again the flag to false
-    m_observing = false;
+  m_worker.stop();
+  
+  if (m_mode != Mode::CONTINUOUS) {
+    return;
   }
+  
+  std::lock_guard<std::mutex> lock {m_mutex};
+  
+  // Stop reading the conversions before stopping the device, so the observer
+  // does not read a stale conversion
+  m_ready_observer->deactivate();
+  m_ready_subscription.reset();
+  m_ready_observer.reset();
+  
+  // Return to single shot mode and disable the comparator
+  auto transaction = m_bus->startTransaction(m_addr);
+  std::uint16_t cmd = m_bus->read<be16>(REG_CONFIG);
+  cmd = addCmd(cmd, CMD_MODE_MASK, CMD_MODE_SINGLE_SHOT);
+  cmd = addCmd(cmd, CMD_COMP_POL_ACTIVE_MASK, CMD_COMP_POL_ACTIVE_LOW);
+  cmd = addCmd(cmd, CMD_COMP_QUE_MASK, CMD_COMP_QUE_DISABLE);
+  m_bus->write<be16>(REG_CONFIG, cmd & ~CMD_CONV_MASK);
+  m_bus->write<be16>(REG_HI_THRESH, DEFAULT_HI_THRESH);
+  m_bus->write<be16>(REG_LO_THRESH, DEFAULT_LO_THRESH);
+  m_mode = Mode::SINGLE_SHOT;
 }
 
-} // end of namespace PiHWCtrl
\ No newline at end of file
+} // end of namespace PiHWCtrl
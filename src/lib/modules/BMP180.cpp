@@ -26,6 +26,10 @@
 #include <chrono> // for std::chrono_literals
 #include <thread>
 #include <map>
+#include <array>
+#include <fstream>
+#include <sstream>
+#include <boost/filesystem.hpp>
 #include <PiHWCtrl/i2c/I2CBus.h>
 #include <PiHWCtrl/i2c/exceptions.h>
 #include <PiHWCtrl/utils/FunctionAnalogInput.h>
@@ -59,6 +63,10 @@ constexpr std::uint8_t REGISTER_CALIBRATION_MB = 0xBA;
 constexpr std::uint8_t REGISTER_CALIBRATION_MC = 0xBC;
 constexpr std::uint8_t REGISTER_CALIBRATION_MD = 0xBE;
 
+// The calibration EEPROM is the block of registers AC1-MD (0xAA-0xBF)
+constexpr std::size_t CALIBRATION_SIZE = 22;
+using CalibrationData = std::array<std::uint8_t, CALIBRATION_SIZE>;
+
 // Useful commands
 constexpr std::uint8_t COMMAND_RESET = 0xB6;
 constexpr std::uint8_t COMMAND_READ_TEMPERATURE = 0x2E;
@@ -83,20 +91,81 @@ std::map<BMP180::PressureMode, ModeInfo> mode_map {
 };
 
 std::mutex instance_exists_mutex;
-bool instance_exists = false;
+// The key is the I2C adapter number, as the address of the BMP180 is fixed
+std::map<int, bool> instance_exist_map {
+};
+
+// Returns the 16 bit big endian word at the given register of the calibration
+std::uint16_t calibrationWord(const CalibrationData& data, std::uint8_t reg) {
+  std::size_t index = reg - REGISTER_CALIBRATION_AC1;
+  return (data[index] << 8) | data[index + 1];
+}
+
+// According to the datasheet none of the calibration words can be 0x0000 or
+// 0xFFFF, so we use this to detect invalid cached data
+bool isCalibrationValid(const CalibrationData& data) {
+  for (std::uint8_t reg = REGISTER_CALIBRATION_AC1; reg <= REGISTER_CALIBRATION_MD; reg += 2) {
+    auto word = calibrationWord(data, reg);
+    if (word == 0x0000 || word == 0xFFFF) {
+      return false;
+    }
+  }
+  return true;
+}
+
+boost::filesystem::path calibrationCacheFile(const std::string& cache_dir, int adapter) {
+  std::stringstream name;
+  name << "i2c-" << adapter << "-0x" << std::hex << (int)BMP180_ADDRESS << ".cal";
+  return boost::filesystem::path{cache_dir} / name.str();
+}
+
+bool readCalibrationCache(const boost::filesystem::path& file, CalibrationData& data) {
+  std::ifstream in {file.string(), std::ios::binary};
+  in.read(reinterpret_cast<char*>(data.data()), data.size());
+  return in.gcount() == static_cast<std::streamsize>(data.size())
+         && in.peek() == std::ifstream::traits_type::eof()
+         && isCalibrationValid(data);
+}
+
+// The cache is only an optimization, so any failure is ignored
+void writeCalibrationCache(const boost::filesystem::path& file, const CalibrationData& data) {
+  boost::system::error_code error;
+  boost::filesystem::create_directories(file.parent_path(), error);
+  if (error) {
+    return;
+  }
+  // We write to a temporary file and rename it, so other processes never see
+  // a partially written cache
+  auto temp = file;
+  temp += ".tmp";
+  {
+    std::ofstream out {temp.string(), std::ios::binary | std::ios::trunc};
+    out.write(reinterpret_cast<const char*>(data.data()), data.size());
+    if (!out) {
+      return;
+    }
+  }
+  boost::filesystem::rename(temp, file, error);
+}
 
 } // end of anonymous namespace
 
-std::unique_ptr<BMP180> BMP180::factory(PressureMode mode, float sea_level_pressure) {
-  return std::unique_ptr<BMP180>{new BMP180{mode, sea_level_pressure}};
+std::unique_ptr<BMP180> BMP180::factory(PressureMode mode, float sea_level_pressure,
+                                        const std::string& calibration_cache_dir,
+                                        int i2c_adapter) {
+  return std::unique_ptr<BMP180>{new BMP180{mode, sea_level_pressure, calibration_cache_dir,
+                                            i2c_adapter}};
 }
 
 
-BMP180::BMP180(PressureMode mode, float sea_level_pressure)
-        : m_mode(mode), m_sea_level_pressure(sea_level_pressure) {
+BMP180::BMP180(PressureMode mode, float sea_level_pressure, const std::string& calibration_cache_dir,
+               int i2c_adapter)
+        : m_bus(I2CBus::open(i2c_adapter)), m_mode(mode), m_sea_level_pressure(sea_level_pressure) {
   
   // Check that there is no other instance controlling the device
   std::unique_lock<std::mutex> lock {instance_exists_mutex};
+  // This will create a new entry with false if the adapter was never used
+  bool& instance_exists = instance_exist_map[i2c_adapter];
   if (instance_exists) {
     throw ModuleAlreadyInUse("BMP180");
   } else {
@@ -104,33 +173,40 @@ BMP180::BMP180(PressureMode mode, float sea_level_pressure)
   }
   lock.unlock();
   
-  // Get the I2C bus
-  auto bus = I2CBus::getSingleton();
-  
   // Start a transaction that will lock the I2C bus from others until we are done
-  auto transaction = bus->startTransaction(BMP180_ADDRESS);
+  auto transaction = m_bus->startTransaction(BMP180_ADDRESS);
   
   // Confirm that we have connected with a BMP180 chip
-  if (bus->readRegister<std::uint8_t>(REGISTER_CHIP_ID) != 0x55) {
+  if (m_bus->read<u8>(REGISTER_CHIP_ID) != 0x55) {
     throw I2CWrongModule() << "Attached module is not a BMP180";
   }
   
   // Perform a soft reset to the device and wait until it has finished
-  bus->writeRegister(REGISTER_RESET, COMMAND_RESET);
+  m_bus->write<u8>(REGISTER_RESET, COMMAND_RESET);
   std::this_thread::sleep_for(RESET_DELAY);
   
-  // Read all the calibration registers
-  m_ac1 = bus->readRegister<std::int16_t>(REGISTER_CALIBRATION_AC1);
-  m_ac2 = bus->readRegister<std::int16_t>(REGISTER_CALIBRATION_AC2);
-  m_ac3 = bus->readRegister<std::int16_t>(REGISTER_CALIBRATION_AC3);
-  m_ac4 = bus->readRegister<std::uint16_t>(REGISTER_CALIBRATION_AC4);
-  m_ac5 = bus->readRegister<std::uint16_t>(REGISTER_CALIBRATION_AC5);
-  m_ac6 = bus->readRegister<std::uint16_t>(REGISTER_CALIBRATION_AC6);
-  m_b1 = bus->readRegister<std::int16_t>(REGISTER_CALIBRATION_B1);
-  m_b2 = bus->readRegister<std::int16_t>(REGISTER_CALIBRATION_B2);
-  m_mb = bus->readRegister<std::int16_t>(REGISTER_CALIBRATION_MB);
-  m_mc = bus->readRegister<std::int16_t>(REGISTER_CALIBRATION_MC);
-  m_md = bus->readRegister<std::int16_t>(REGISTER_CALIBRATION_MD);
+  // Get the calibration coefficients, from the cache if we have them, or from
+  // the EEPROM of the device with a single block read
+  CalibrationData calibration;
+  bool use_cache = !calibration_cache_dir.empty();
+  auto cache_file = calibrationCacheFile(calibration_cache_dir, m_bus->getAdapterNumber());
+  if (!use_cache || !readCalibrationCache(cache_file, calibration)) {
+    m_bus->readRegisterBlock(REGISTER_CALIBRATION_AC1, calibration.data(), calibration.size());
+    if (use_cache && isCalibrationValid(calibration)) {
+      writeCalibrationCache(cache_file, calibration);
+    }
+  }
+  m_ac1 = calibrationWord(calibration, REGISTER_CALIBRATION_AC1);
+  m_ac2 = calibrationWord(calibration, REGISTER_CALIBRATION_AC2);
+  m_ac3 = calibrationWord(calibration, REGISTER_CALIBRATION_AC3);
+  m_ac4 = calibrationWord(calibration, REGISTER_CALIBRATION_AC4);
+  m_ac5 = calibrationWord(calibration, REGISTER_CALIBRATION_AC5);
+  m_ac6 = calibrationWord(calibration, REGISTER_CALIBRATION_AC6);
+  m_b1 = calibrationWord(calibration, REGISTER_CALIBRATION_B1);
+  m_b2 = calibrationWord(calibration, REGISTER_CALIBRATION_B2);
+  m_mb = calibrationWord(calibration, REGISTER_CALIBRATION_MB);
+  m_mc = calibrationWord(calibration, REGISTER_CALIBRATION_MC);
+  m_md = calibrationWord(calibration, REGISTER_CALIBRATION_MD);
   
 }
 
@@ -139,7 +215,7 @@ BMP180::~BMP180() {
   stop();
   // Release the instance_exists flag so new classes can be created
   std::lock_guard<std::mutex> lock {instance_exists_mutex};
-  instance_exists = false;
+  instance_exist_map.at(m_bus->getAdapterNumber()) = false;
 }
 
 std::uint16_t BMP180::readRawTemperature() {
@@ -154,15 +230,12 @@ std::uint16_t BMP180::readRawTemperature() {
   }
   m_last_temperature_timestamp = std::chrono::steady_clock::now();
 
-  // Get the I2C bus
-  auto bus = I2CBus::getSingleton();
-  
   // Request the measurement by writing to the control register. We do that in a
   // scope so we don't block the I2C bus while waiting for the measurement to
   // be done.
   {
-    auto transaction = bus->startTransaction(BMP180_ADDRESS);
-    bus->writeRegister(REGISTER_MEASUREMENT_CONTROL, COMMAND_READ_TEMPERATURE);
+    auto transaction = m_bus->startTransaction(BMP180_ADDRESS);
+    m_bus->write<u8>(REGISTER_MEASUREMENT_CONTROL, COMMAND_READ_TEMPERATURE);
   }
   
   // Wait until the measurement is completed
@@ -170,8 +243,8 @@ std::uint16_t BMP180::readRawTemperature() {
   
   // Read the uncompensated temperature value from the sensor
   {
-    auto transaction = bus->startTransaction(BMP180_ADDRESS);
-    m_last_temperature = bus->readRegister<std::uint16_t>(REGISTER_OUT);
+    auto transaction = m_bus->startTransaction(BMP180_ADDRESS);
+    m_last_temperature = m_bus->read<be16>(REGISTER_OUT);
   }
   
   return m_last_temperature;
@@ -184,7 +257,6 @@ std::unique_ptr<AnalogInput<std::uint16_t>> BMP180::rawTemperatureAnalogInput()
 }
 
 void BMP180::addRawTemperatureObserver(std::shared_ptr<Observer<std::uint16_t>> observer) {
-  std::lock_guard<std::mutex> lock {m_mutex};
   m_raw_temperature_observable.addObserver(observer);
 }
 
@@ -212,7 +284,6 @@ std::unique_ptr<AnalogInput<float>> BMP180::temperatureAnalogInput() {
 }
 
 void BMP180::addTemperatureObserver(std::shared_ptr<Observer<float>> observer) {
-  std::lock_guard<std::mutex> lock {m_mutex};
   m_temperature_observable.addObserver(observer);
 }
 
@@ -222,16 +293,13 @@ std::uint32_t BMP180::readRawPressure() {
   // Get the mode info from the map
   auto& mode_info = mode_map.at(m_mode);
   
-  // Get the I2C bus
-  auto bus = I2CBus::getSingleton();
-  
   // Request the measurement by writing to the control register we do that in a
   // scope so we don't block the I2C bus while waiting for the measurement to
   // be done.
   {
-    auto transaction = bus->startTransaction(BMP180_ADDRESS);
+    auto transaction = m_bus->startTransaction(BMP180_ADDRESS);
     std::uint8_t cmd = COMMAND_READ_PRESSURE + (mode_info.oss << 6);
-    bus->writeRegister(REGISTER_MEASUREMENT_CONTROL, cmd);
+    m_bus->write<u8>(REGISTER_MEASUREMENT_CONTROL, cmd);
   }
   
   // Wait for the measurement to be completed
@@ -240,10 +308,8 @@ std::uint32_t BMP180::readRawPressure() {
   // Read the uncompensated pressure value from the sensor
   std::uint32_t up = 0;
   {
-    auto transaction = bus->startTransaction(BMP180_ADDRESS);
-    auto buffer = bus->readRegisterAsArray<3>(REGISTER_OUT);
-    up = ((buffer[0] & 0xFF) << 16) | ((buffer[1] & 0xFF) << 8) | (buffer[2] & 0xFF);
-    up = up >> (8 - mode_info.oss);
+    auto transaction = m_bus->startTransaction(BMP180_ADDRESS);
+    up = m_bus->read<be24>(REGISTER_OUT) >> (8 - mode_info.oss);
   }
   
   return up;
@@ -256,7 +322,6 @@ std::unique_ptr<AnalogInput<std::uint32_t>> BMP180::rawPressureAnalogInput() {
 }
 
 void BMP180::addRawPressureObserver(std::shared_ptr<Observer<std::uint32_t>> observer) {
-  std::lock_guard<std::mutex> lock {m_mutex};
   m_raw_pressure_observable.addObserver(observer);
 }
 
@@ -302,7 +367,6 @@ std::unique_ptr<AnalogInput<float>> BMP180::pressureAnalogInput() {
 }
 
 void BMP180::addPressureObserver(std::shared_ptr<Observer<float>> observer) {
-  std::lock_guard<std::mutex> lock {m_mutex};
   m_pressure_observable.addObserver(observer);
 }
 
@@ -323,7 +387,6 @@ std::unique_ptr<AnalogInput<float>> BMP180::altitudeAnalogInput() {
 }
 
 void BMP180::addAltitudeObserver(std::shared_ptr<Observer<float>> observer) {
-  std::lock_guard<std::mutex> lock {m_mutex};
   m_altitude_observable.addObserver(observer);
 }
 
@@ -341,57 +404,46 @@ float BMP180::calibrateSeaLevelPressure(float altitude) {
   return m_sea_level_pressure;
 }
 
-void BMP180::start() {
-  if (m_observing) {
+void BMP180::start(unsigned int period_ms) {
+  if (m_worker.isRunning()) {
     throw Exception() << "BMP180 already started";
   }
-  m_observing = true;
 
   auto measurement_task = [this]() {
-    while (m_observing) {
-      std::uint16_t ut = readRawTemperature();
-      std::unique_lock<std::mutex> lock {m_mutex};
-      m_raw_temperature_observable.createEvent(ut);
-      lock.unlock();
-      
-      std::int32_t b5 = computeB5(ut);
-      float temperature = computeRealTemperature(ut, b5);
-      lock.lock();
-      m_temperature_observable.createEvent(temperature);
-      lock.unlock();
-      
-      std::uint32_t up = readRawPressure();
-      lock.lock();
-      m_raw_pressure_observable.createEvent(up);
-      lock.unlock();
-      
-      float pressure = computeRealPressure(ut, up);
-      lock.lock();
-      m_pressure_observable.createEvent(pressure);
-      lock.unlock();
-      
-      float altitude = computeAltitude(pressure);
-      lock.lock();
-      m_altitude_observable.createEvent(altitude);
-      lock.unlock();
+    // The observables are thread safe, so we do not need to lock while
+    // notifying the observers
+    std::uint16_t ut = readRawTemperature();
+    m_raw_temperature_observable.createEvent(ut);
+
+    std::int32_t b5 = computeB5(ut);
+    float temperature = computeRealTemperature(ut, b5);
+    m_temperature_observable.createEvent(temperature);
+
+    // The pressure measurement can take up to 25.5 ms, so we do not start it
+    // if we are asked to stop
+    if (m_worker.stopRequested()) {
+      return;
     }
-    m_observing = true;
+
+    std::uint32_t up = readRawPressure();
+    m_raw_pressure_observable.createEvent(up);
+
+    float pressure = computeRealPressure(ut, up);
+    m_pressure_observable.createEvent(pressure);
+
+    float altitude = computeAltitude(pressure);
+    m_altitude_observable.createEvent(altitude);
   };
   
-  std::thread t {measurement_task};
-  t.detach();
+  m_worker.start(measurement_task, std::chrono::milliseconds(period_ms));
+}
+
+std::shared_ptr<PeriodStatistics> BMP180::getStatistics() const {
+  return m_worker.getStatistics();
 }
 
 void BMP180::stop() {
-  if (m_observing) {
-    // This will trigger the measuring thread to stop
-    m_observing = false;
-    // We have to wait until the thread signals that it stopped
-    while (!m_observing) {
-    }
-    // Now we can set again the flag to false
-    m_observing = false;
-  }
+  m_worker.stop();
 }
 
 } // end of namespace PiHWCtrl
\ No newline at end of file
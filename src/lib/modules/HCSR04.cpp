@@ -24,7 +24,6 @@
 #include <thread> // for std::this_thread
 #include <algorithm> // for std::min
 #include <PiHWCtrl/modules/HCSR04.h>
-#include <PiHWCtrl/utils/EventGenerator.h>
 #include <PiHWCtrl/HWInterfaces/exceptions.h>
 
 // We introduce the symbols from std::chrono_literals so we can write time
@@ -83,30 +82,22 @@ float HCSR04::readValue() {
   return readDistance();
 }
 
-void HCSR04::start(unsigned int sleep_ms) {
-  if (m_observing) {
+void HCSR04::start(unsigned int period_ms) {
+  if (m_worker.isRunning()) {
     throw Exception() << "HCSR04 already started";
   }
-  m_observing = true;
-  auto event_func = [this]() {
-    return readDistance();
+  auto measurement_task = [this]() {
+    notifyObservers(readDistance());
   };
-  auto notify_func = [this](float value) {
-    notifyObservers(value);
-  };
-  startEventGenerator<float>(event_func, notify_func, m_observing, sleep_ms);
+  m_worker.start(measurement_task, std::chrono::milliseconds(period_ms));
 }
 
 void HCSR04::stop() {
-  if (m_observing) {
-    // This will trigger the EventGenerator thread to stop
-    m_observing = false;
-    // We have to wait until the thread signals that it stopped
-    while (!m_observing) {
-    }
-    // Now we can set again the flag to false
-    m_observing = false;
-  }
+  m_worker.stop();
+}
+
+std::shared_ptr<PeriodStatistics> HCSR04::getStatistics() const {
+  return m_worker.getStatistics();
 }
 
 } // end of namespace PiHWCtrl
\ No newline at end of file
@@ -57,7 +57,8 @@ constexpr std::uint16_t CMD_LED_FULL_OFF = 0x1000;
 
 std::mutex instance_exists_mutex;
 
-std::map<std::uint8_t, bool> instance_exist_map {
+// The key is the I2C adapter number and the address of the device
+std::map<std::pair<int, std::uint8_t>, bool> instance_exist_map {
 };
 
 class LedPwm : public PWM {
@@ -86,11 +87,13 @@ private:
 
 } // end of anonymous namespace
 
-std::unique_ptr<PCA9685> PCA9685::factory(std::uint8_t address, int pwm_frequency) {
-  return std::unique_ptr<PCA9685>{new PCA9685{address, pwm_frequency}};
+std::unique_ptr<PCA9685> PCA9685::factory(std::uint8_t address, int pwm_frequency,
+                                          int i2c_adapter) {
+  return std::unique_ptr<PCA9685>{new PCA9685{address, pwm_frequency, i2c_adapter}};
 }
 
-PCA9685::PCA9685(std::uint8_t address, int pwm_frequency) : m_address(address) {
+PCA9685::PCA9685(std::uint8_t address, int pwm_frequency, int i2c_adapter)
+        : m_bus(I2CBus::open(i2c_adapter)), m_address(address) {
   
   // First check that the pwm_frequency is in the valid range
   if (pwm_frequency < 24 || pwm_frequency > 1526) {
@@ -100,46 +103,44 @@ PCA9685::PCA9685(std::uint8_t address, int pwm_frequency) : m_address(address) {
 
   // Check that there is no other instance controlling this address
   std::unique_lock<std::mutex> lock {instance_exists_mutex};
-  auto instance_iter = instance_exist_map.find(m_address);
+  auto instance_iter = instance_exist_map.find({i2c_adapter, m_address});
   if (instance_iter != instance_exist_map.end() && instance_iter->second) {
     throw ModuleAlreadyInUse("PCA9685-"+m_address);
   } else {
     // This will either change the value of an existing key or create a new entry
-    instance_exist_map[m_address] = true;
+    instance_exist_map[{i2c_adapter, m_address}] = true;
   }
   lock.unlock();
   
-  // Get the I2C bus
-  auto bus = I2CBus::getSingleton();
-  
   // First initialize and wake up the device. We set the auto-increment on so
   // we can read the registers as 16 bit integers, we set the sleep to off to
   // wake up the device and we turn off the ALLCALL.
   {
-    auto transaction = bus->startTransaction(m_address);
+    auto transaction = m_bus->startTransaction(m_address);
     std::uint8_t cmd = 0x00;
     cmd |= CMD_AUTO_INCR;
-    bus->writeRegister(REG_MODE1, cmd);
+    m_bus->write<u8>(REG_MODE1, cmd);
   }
   
   // Sleep for 500us for the oscillator to stabilize
   std::this_thread::sleep_for(500us);
   
-  // Set all the LEDs to full OFF and all their registers to zero values
-  auto transaction = bus->startTransaction(m_address);
-  bus->writeRegister(REG_ALL_LED_ON, 0x0000);
-  bus->writeRegister(REG_ALL_LED_OFF, CMD_LED_FULL_OFF);
-  
-  // Set the PRE_SCALE for the requested frequency
+  // Set all the LEDs to full OFF and all their registers to zero values, and
+  // set the PRE_SCALE for the requested frequency, all with a single batch
+  auto transaction = m_bus->startTransaction(m_address);
+  auto batch = transaction.batch();
+  batch.write<le16>(REG_ALL_LED_ON, 0x0000);
+  batch.write<le16>(REG_ALL_LED_OFF, CMD_LED_FULL_OFF);
   std::uint8_t prescale = std::round(25e6 / (4096. * pwm_frequency)) -1;
-  bus->writeRegister(REG_PRE_SCALE, prescale);
+  batch.write<u8>(REG_PRE_SCALE, prescale);
+  batch.submit();
   
 } // end of PCA9685 constructor
 
 PCA9685::~PCA9685() {
   // Release the instance_exists flag so new classes can be created
   std::lock_guard<std::mutex> lock {instance_exists_mutex};
-  instance_exist_map.at(m_address) = false;
+  instance_exist_map.at({m_bus->getAdapterNumber(), m_address}) = false;
 }
 
 void PCA9685::setDutyCycle(int channel, float duty_cycle) {
@@ -168,14 +169,12 @@ void PCA9685::setDutyCycle(int channel, float duty_cycle) {
   
   std::lock_guard<std::mutex> lock {m_mutex};
 
-  // Get the I2C bus
-  auto bus = I2CBus::getSingleton();
-  
-  auto transaction = bus->startTransaction(m_address);
+  // The duty cycle updates get the bus before any waiting sensor transaction
+  auto transaction = m_bus->startTransaction(m_address, I2CBusLock::Priority::REALTIME);
   
   // Write the registers
-  bus->writeRegister(led_on_reg, on);
-  bus->writeRegister(led_off_reg, off);
+  m_bus->write<le16>(led_on_reg, on);
+  m_bus->write<le16>(led_off_reg, off);
   
 } // end of setDutyCycle()
 
@@ -186,14 +185,11 @@ float PCA9685::getDutyCycle(int channel) {
   
   std::lock_guard<std::mutex> lock {m_mutex};
 
-  // Get the I2C bus
-  auto bus = I2CBus::getSingleton();
-  
-  auto transaction = bus->startTransaction(m_address);
+  auto transaction = m_bus->startTransaction(m_address);
   
   // Read the registers
-  std::uint16_t on = bus->readRegister<std::uint16_t>(led_on_reg, true);
-  std::uint16_t off = bus->readRegister<std::uint16_t>(led_off_reg, true);
+  std::uint16_t on = m_bus->read<le16>(led_on_reg);
+  std::uint16_t off = m_bus->read<le16>(led_off_reg);
   
   // Check if we have full ON or full OFF enabled
   if (off & CMD_LED_FULL_OFF) {
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file PigpioGpioBank.cpp
+ * @author nikoapos
+ */
+
+#include <pigpio.h>
+#include <PiHWCtrl/utils/GpioManager.h>
+#include <PiHWCtrl/pigpio/exceptions.h>
+#include <PiHWCtrl/pigpio/PigpioGpioBank.h>
+
+namespace PiHWCtrl {
+
+PigpioGpioBank::PigpioGpioBank(const std::vector<int>& gpios, Mode mode)
+        : m_gpios(gpios), m_mode(mode) {
+  if (m_gpios.size() > 32) {
+    throw Exception() << "A GPIO bank can have maximum 32 GPIOs";
+  }
+  unsigned int pigpio_mode = (m_mode == Mode::INPUT) ? PI_INPUT : PI_OUTPUT;
+  for (int gpio : m_gpios) {
+    m_gpio_reservations.push_back(GpioManager::getSingleton()->reserveGpio(gpio));
+    auto res = gpioSetMode(gpio, pigpio_mode);
+    if (res == PI_BAD_GPIO) {
+      throw BadGpioNumber(gpio);
+    } else if (res == PI_BAD_MODE) {
+      throw BadGpioMode(gpio, pigpio_mode);
+    } else if (res != 0) {
+      throw UnknownPigpioException(res);
+    }
+  }
+}
+
+void PigpioGpioBank::write(std::uint32_t word) {
+  if (m_mode == Mode::INPUT) {
+    throw Exception() << "Cannot write to a GPIO bank in INPUT mode";
+  }
+  
+  // Convert the word to the masks of the GPIOs to set and to clear
+  std::uint32_t set_bits = 0;
+  std::uint32_t clear_bits = 0;
+  for (std::size_t i = 0; i < m_gpios.size(); ++i) {
+    if (word & (std::uint32_t{1} << i)) {
+      set_bits |= std::uint32_t{1} << m_gpios[i];
+    } else {
+      clear_bits |= std::uint32_t{1} << m_gpios[i];
+    }
+  }
+  
+  if (set_bits != 0) {
+    gpioWrite_Bits_0_31_Set(set_bits);
+  }
+  if (clear_bits != 0) {
+    gpioWrite_Bits_0_31_Clear(clear_bits);
+  }
+}
+
+std::uint32_t PigpioGpioBank::read() const {
+  // Read all the GPIOs at once and pick the bits of the bank
+  std::uint32_t levels = gpioRead_Bits_0_31();
+  std::uint32_t word = 0;
+  for (std::size_t i = 0; i < m_gpios.size(); ++i) {
+    if (levels & (std::uint32_t{1} << m_gpios[i])) {
+      word |= std::uint32_t{1} << i;
+    }
+  }
+  return word;
+}
+
+} // end of namespace PiHWCtrl
@@ -22,6 +22,10 @@
 
 #include <string>
 #include <map>
+#include <fstream> // for std::ifstream
+#include <cstring> // for std::memset
+#include <algorithm> // for std::min
+#include <cerrno> // for errno and EINVAL
 #include <fcntl.h> // For open()
 #include <unistd.h> // For close()
 #include <PiHWCtrl/utils/GpioManager.h>
@@ -38,18 +42,25 @@ constexpr int SPI_SCLK_GPIO = 11;
 constexpr int SPI_MOSI_GPIO = 10;
 constexpr int SPI_MISO_GPIO = 9;
 
-constexpr std::uint8_t SPI_MODE = SPI_MODE_0;
-constexpr std::uint8_t SPI_BITS_PER_WORD = 8;
+constexpr int AUX_SPI_CE0_GPIO = 18;
+constexpr int AUX_SPI_CE1_GPIO = 17;
+constexpr int AUX_SPI_CE2_GPIO = 16;
+constexpr int AUX_SPI_SCLK_GPIO = 21;
+constexpr int AUX_SPI_MOSI_GPIO = 20;
+constexpr int AUX_SPI_MISO_GPIO = 19;
+
 constexpr std::uint16_t SPI_DELAY = 0;
 
-struct DeviceInfo {
-  std::string filename;
-  int gpio;
-};
+// The file with the buffer size of the spidev driver, which limits the size
+// of a single message, and its default value
+constexpr const char* SPIDEV_BUFSIZ_FILE = "/sys/module/spidev/parameters/bufsiz";
+constexpr std::size_t SPIDEV_DEFAULT_BUFSIZ = 4096;
 
-std::map<SPIBus::Device, DeviceInfo> device_info_map {
-  {SPIBus::Device::CE_0, {"/dev/spidev0.0", SPI_CE0_GPIO}},
-  {SPIBus::Device::CE_1, {"/dev/spidev0.1", SPI_CE1_GPIO}}
+std::map<SPIBus::Mode, std::uint8_t> mode_info_map {
+  {SPIBus::Mode::MODE_0, SPI_MODE_0},
+  {SPIBus::Mode::MODE_1, SPI_MODE_1},
+  {SPIBus::Mode::MODE_2, SPI_MODE_2},
+  {SPIBus::Mode::MODE_3, SPI_MODE_3}
 };
 
 std::map<SPIBus::Speed, std::uint32_t> speed_info_map {
@@ -70,18 +81,32 @@ std::map<SPIBus::Speed, std::uint32_t> speed_info_map {
   {SPIBus::Speed::S_125_MHz, 125000000}
 };
 
-struct SpiGpioManager {
+// The state shared by the devices of an SPI controller
+struct SpiController {
+  
+  SpiController(int sclk_gpio, int mosi_gpio, int miso_gpio)
+          : m_sclk_gpio(sclk_gpio), m_mosi_gpio(mosi_gpio), m_miso_gpio(miso_gpio) {
+  }
   
   void reserveGpios() {
+    std::lock_guard<std::mutex> lock {m_gpio_mutex};
     if (m_device_count == 0) {
-      m_sclk = GpioManager::getSingleton()->reserveGpio(SPI_SCLK_GPIO);
-      m_mosi = GpioManager::getSingleton()->reserveGpio(SPI_MOSI_GPIO);
-      m_miso = GpioManager::getSingleton()->reserveGpio(SPI_MISO_GPIO);
+      try {
+        m_sclk = GpioManager::getSingleton()->reserveGpio(m_sclk_gpio);
+        m_mosi = GpioManager::getSingleton()->reserveGpio(m_mosi_gpio);
+        m_miso = GpioManager::getSingleton()->reserveGpio(m_miso_gpio);
+      } catch (...) {
+        m_sclk.reset();
+        m_mosi.reset();
+        m_miso.reset();
+        throw;
+      }
     }
     ++m_device_count;
   }
   
   void releaseGpios() {
+    std::lock_guard<std::mutex> lock {m_gpio_mutex};
     --m_device_count;
     if (m_device_count == 0) {
       m_sclk.reset();
@@ -90,60 +115,242 @@ struct SpiGpioManager {
     }
   }
   
+  int m_sclk_gpio;
+  int m_mosi_gpio;
+  int m_miso_gpio;
+  // Protects the device counter and the reservations of the common GPIOs
+  std::mutex m_gpio_mutex;
   int m_device_count = 0;
   std::unique_ptr<GpioManager::GpioReservation> m_sclk;
   std::unique_ptr<GpioManager::GpioReservation> m_mosi;
   std::unique_ptr<GpioManager::GpioReservation> m_miso;
+  // Serializes the transfers of all the devices of the controller
+  std::recursive_mutex m_transfer_mutex;
   
 };
 
-SpiGpioManager spi_gpio_manager {};
+// The main and the auxiliary SPI controllers
+SpiController spi_controller {SPI_SCLK_GPIO, SPI_MOSI_GPIO, SPI_MISO_GPIO};
+SpiController aux_spi_controller {AUX_SPI_SCLK_GPIO, AUX_SPI_MOSI_GPIO, AUX_SPI_MISO_GPIO};
+
+struct DeviceInfo {
+  std::string filename;
+  int gpio;
+  SpiController& controller;
+};
+
+std::map<SPIBus::Device, DeviceInfo> device_info_map {
+  {SPIBus::Device::CE_0,     {"/dev/spidev0.0", SPI_CE0_GPIO,     spi_controller}},
+  {SPIBus::Device::CE_1,     {"/dev/spidev0.1", SPI_CE1_GPIO,     spi_controller}},
+  {SPIBus::Device::AUX_CE_0, {"/dev/spidev1.0", AUX_SPI_CE0_GPIO, aux_spi_controller}},
+  {SPIBus::Device::AUX_CE_1, {"/dev/spidev1.1", AUX_SPI_CE1_GPIO, aux_spi_controller}},
+  {SPIBus::Device::AUX_CE_2, {"/dev/spidev1.2", AUX_SPI_CE2_GPIO, aux_spi_controller}}
+};
 
 } // end of anonymous namespace
 
-SPIBus::SPIBus(Device device, Speed speed) : m_device(device) {
-  // Reserve the common SPI GPIOs
-  spi_gpio_manager.reserveGpios();
-  
-  // Reserve the SPI_CE GPIO for the given device
+constexpr std::size_t SPIBus::MAX_SEGMENTS;
+
+SPIBus::SPIBus(Device device, Speed speed, Mode mode, std::uint8_t bits_per_word)
+        : m_device(device) {
   auto& device_info = device_info_map.at(m_device);
-  m_ce_gpio_reservation = GpioManager::getSingleton()->reserveGpio(device_info.gpio);
+  m_controller_mutex = &device_info.controller.m_transfer_mutex;
+  
+  // Reserve the common GPIOs of the SPI controller of the device
+  device_info.controller.reserveGpios();
+  
+  try {
+    // Reserve the SPI_CE GPIO for the given device
+    m_ce_gpio_reservation = GpioManager::getSingleton()->reserveGpio(device_info.gpio);
+  } catch (...) {
+    device_info.controller.releaseGpios();
+    throw;
+  }
   
   // Open the file for using the bus
   m_bus_file = open(device_info.filename.c_str(), O_RDWR);
   if (m_bus_file < 0) {
+    device_info.controller.releaseGpios();
     throw SPIBusOpenFailure(device_info.filename);
   }
   
-  // Set the SPI mode
-  if (ioctl(m_bus_file, SPI_IOC_WR_MODE, &SPI_MODE) != 0) {
-    throw SPIModeException(SPI_MODE);
-  }
+  // The bit order is written together with the mode
+  m_lsb_first = false;
   
-  // Set the SPI bits per word
-  if (ioctl(m_bus_file, SPI_IOC_WR_BITS_PER_WORD, &SPI_BITS_PER_WORD) != 0) {
-    throw SPIBitsPerWordException(SPI_BITS_PER_WORD);
+  try {
+    setMode(mode);
+    // Apply explicitly the bit order after the mode, so a device left in
+    // LSB-first mode by a previous process does not keep it
+    setLsbFirst(false);
+    setBitsPerWord(bits_per_word);
+    setSpeed(speed);
+  } catch (...) {
+    device_info.controller.releaseGpios();
+    close(m_bus_file);
+    throw;
   }
+  m_delay_usecs = SPI_DELAY;
   
-  // Set the max speed of the bus
-  if (ioctl(m_bus_file, SPI_IOC_WR_MAX_SPEED_HZ, &(speed_info_map.at(speed))) != 0) {
-    throw SPISpeedException(speed_info_map.at(speed));
+  // Get the maximum size of the messages
+  m_max_transfer_size = SPIDEV_DEFAULT_BUFSIZ;
+  std::ifstream bufsiz_file {SPIDEV_BUFSIZ_FILE};
+  std::size_t bufsiz;
+  if (bufsiz_file >> bufsiz && bufsiz > 0) {
+    m_max_transfer_size = bufsiz;
   }
   
-  // Setup the required info for the spi_ioc_transfer object that will be used
-  // for the transfers
-  m_delay_usecs = SPI_DELAY;
-  m_speed_hz = speed_info_map.at(speed);
-  m_bits_per_word = SPI_BITS_PER_WORD;
-  
 }
 
 SPIBus::~SPIBus() {
   // Release the common SPI GPIOs
-  spi_gpio_manager.releaseGpios();
+  device_info_map.at(m_device).controller.releaseGpios();
   
   // Close the bus file
   close(m_bus_file);
 }
 
+SPITransaction SPIBus::startTransaction() {
+  return SPITransaction {*m_controller_mutex};
+}
+
+void SPIBus::transfer(const std::uint8_t* tx, std::uint8_t* rx, std::size_t size) {
+  // Send the data in messages that fit in the buffer of the driver, without
+  // transfers of other threads between them
+  std::lock_guard<std::recursive_mutex> lock {*m_controller_mutex};
+  std::size_t offset = 0;
+  while (offset < size) {
+    SPISegment segment {tx ? tx + offset : nullptr, rx ? rx + offset : nullptr,
+                        std::min(size - offset, m_max_transfer_size), false, m_delay_usecs, 0};
+    transfer(&segment, 1);
+    offset += segment.size;
+  }
+}
+
+void SPIBus::transfer(const SPISegment* segments, std::size_t count) {
+  if (count == 0) {
+    return;
+  }
+  if (count > MAX_SEGMENTS) {
+    throw SPITooManySegments(count, MAX_SEGMENTS);
+  }
+  
+  std::lock_guard<std::recursive_mutex> lock {*m_controller_mutex};
+  
+  // Fill the transfer descriptors of the segments
+  m_transfers.resize(count);
+  std::size_t total_size = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    auto& tr = m_transfers[i];
+    std::memset(&tr, 0, sizeof(tr));
+    tr.tx_buf = reinterpret_cast<std::uintptr_t>(segments[i].tx);
+    tr.rx_buf = reinterpret_cast<std::uintptr_t>(segments[i].rx);
+    tr.len = segments[i].size;
+    tr.delay_usecs = segments[i].delay_usecs;
+    tr.speed_hz = segments[i].speed_hz != 0 ? segments[i].speed_hz : m_speed_hz;
+    tr.bits_per_word = m_bits_per_word;
+    tr.cs_change = segments[i].cs_change ? 1 : 0;
+    total_size += segments[i].size;
+  }
+  if (total_size > m_max_transfer_size) {
+    throw SPIMessageTooLong(total_size, m_max_transfer_size);
+  }
+  
+  if (ioctl(m_bus_file, SPI_IOC_MESSAGE(count), m_transfers.data()) != static_cast<int>(total_size)) {
+    throw SPITransferException();
+  }
+}
+
+void SPIBus::setMode(Mode mode) {
+  std::lock_guard<std::recursive_mutex> lock {*m_controller_mutex};
+  std::uint8_t value = mode_info_map.at(mode);
+  if (m_applied.mode == value) {
+    return;
+  }
+  // The SPI_IOC_WR_MODE overwrites all the mode bits of the device, including
+  // the bit order, so we write the current bit order together with the mode
+  std::uint8_t mode_bits = value | (m_lsb_first ? SPI_LSB_FIRST : 0);
+  if (ioctl(m_bus_file, SPI_IOC_WR_MODE, &mode_bits) != 0) {
+    throw SPIModeException(value);
+  }
+  m_applied.mode = value;
+  // The mode and the bit order share the same word of the driver, so the
+  // next setLsbFirst() must not trust the cached bit order
+  m_applied.lsb_first = -1;
+  m_mode = mode;
+}
+
+void SPIBus::setLsbFirst(bool lsb_first) {
+  std::lock_guard<std::recursive_mutex> lock {*m_controller_mutex};
+  std::uint8_t value = lsb_first ? 1 : 0;
+  if (m_applied.lsb_first == value) {
+    return;
+  }
+  if (ioctl(m_bus_file, SPI_IOC_WR_LSB_FIRST, &value) != 0) {
+    throw SPILsbFirstException(lsb_first);
+  }
+  m_applied.lsb_first = value;
+  m_lsb_first = lsb_first;
+}
+
+void SPIBus::setBitsPerWord(std::uint8_t bits_per_word) {
+  std::lock_guard<std::recursive_mutex> lock {*m_controller_mutex};
+  if (m_applied.bits_per_word == bits_per_word) {
+    return;
+  }
+  // The transfers use the bits per word of the instance, but the driver checks
+  // that the controller supports it only with the ioctl
+  if (ioctl(m_bus_file, SPI_IOC_WR_BITS_PER_WORD, &bits_per_word) != 0) {
+    throw SPIBitsPerWordException(bits_per_word);
+  }
+  m_applied.bits_per_word = bits_per_word;
+  m_bits_per_word = bits_per_word;
+}
+
+void SPIBus::setSpeed(Speed speed) {
+  setSpeedHz(speed_info_map.at(speed));
+}
+
+void SPIBus::setSpeedHz(std::uint32_t speed_hz) {
+  // The speed is given with each transfer, so instances with different speeds
+  // can share the bus. The ioctl only checks the value.
+  std::lock_guard<std::recursive_mutex> lock {*m_controller_mutex};
+  if (speed_hz == 0) {
+    errno = EINVAL;
+    throw SPISpeedException(speed_hz);
+  }
+  if (m_applied.speed_hz == speed_hz) {
+    return;
+  }
+  if (ioctl(m_bus_file, SPI_IOC_WR_MAX_SPEED_HZ, &speed_hz) != 0) {
+    throw SPISpeedException(speed_hz);
+  }
+  m_applied.speed_hz = speed_hz;
+  m_speed_hz = speed_hz;
+}
+
+void SPIBus::setDelay(std::uint16_t delay_usecs) {
+  std::lock_guard<std::recursive_mutex> lock {*m_controller_mutex};
+  m_delay_usecs = delay_usecs;
+}
+
+auto SPIBus::getMode() const -> Mode {
+  return m_mode;
+}
+
+bool SPIBus::isLsbFirst() const {
+  return m_lsb_first;
+}
+
+std::uint8_t SPIBus::getBitsPerWord() const {
+  return m_bits_per_word;
+}
+
+std::uint32_t SPIBus::getSpeedHz() const {
+  return m_speed_hz;
+}
+
+std::size_t SPIBus::getMaxTransferSize() const {
+  return m_max_transfer_size;
+}
+
 } // end of namespace PiHWCtrl
\ No newline at end of file
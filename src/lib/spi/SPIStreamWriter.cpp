@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file spi/SPIStreamWriter.cpp
+ * @author nikoapos
+ */
+
+#include <cstring> // for std::memcpy
+#include <algorithm> // for std::min and std::none_of
+#include <new> // for std::bad_alloc
+#include <unistd.h> // for sysconf()
+#include <PiHWCtrl/spi/SPIStreamWriter.h>
+#include <PiHWCtrl/spi/exceptions.h>
+
+namespace PiHWCtrl {
+
+constexpr int SPIStreamWriter::BUFFERS;
+
+SPIStreamWriter::SPIStreamWriter(SPIBus& bus, std::size_t chunk_size)
+        : m_bus(bus), m_chunk_size(chunk_size == 0 ? bus.getMaxTransferSize() : chunk_size) {
+  if (m_chunk_size > bus.getMaxTransferSize()) {
+    throw SPIMessageTooLong(m_chunk_size, bus.getMaxTransferSize());
+  }
+  
+  // Allocate the buffers aligned to the memory pages, so the driver can map
+  // them for DMA without crossing unnecessary page boundaries
+  std::size_t page_size = sysconf(_SC_PAGESIZE);
+  for (auto& buffer : m_buffers) {
+    void* data = nullptr;
+    if (posix_memalign(&data, page_size, m_chunk_size) != 0) {
+      throw std::bad_alloc();
+    }
+    buffer.data.reset(static_cast<std::uint8_t*>(data));
+    buffer.size = 0;
+    buffer.busy = false;
+  }
+  
+  m_thread = std::thread {[this]() { sendLoop(); }};
+}
+
+SPIStreamWriter::~SPIStreamWriter() {
+  try {
+    flush();
+  } catch (...) {
+  }
+  {
+    std::lock_guard<std::mutex> lock {m_mutex};
+    m_stopping = true;
+  }
+  m_condition.notify_all();
+  m_thread.join();
+}
+
+void SPIStreamWriter::write(const std::uint8_t* data, std::size_t size) {
+  while (size > 0) {
+    std::size_t space = std::min(nextSpace(), size);
+    auto& buffer = m_buffers[m_current];
+    std::memcpy(buffer.data.get() + buffer.size, data, space);
+    buffer.size += space;
+    data += space;
+    size -= space;
+  }
+}
+
+void SPIStreamWriter::generate(std::size_t size, Producer producer) {
+  while (size > 0) {
+    std::size_t space = std::min(nextSpace(), size);
+    auto& buffer = m_buffers[m_current];
+    producer(buffer.data.get() + buffer.size, space);
+    buffer.size += space;
+    size -= space;
+  }
+}
+
+void SPIStreamWriter::flush() {
+  std::unique_lock<std::mutex> lock {m_mutex};
+  if (m_buffers[m_current].size > 0) {
+    submitCurrent(lock);
+  }
+  m_condition.wait(lock, [this]() {
+    return std::none_of(m_buffers.begin(), m_buffers.end(), [](const Buffer& b) { return b.busy; });
+  });
+  checkError();
+}
+
+std::size_t SPIStreamWriter::getChunkSize() const {
+  return m_chunk_size;
+}
+
+std::size_t SPIStreamWriter::nextSpace() {
+  // Only the caller thread modifies the current buffer, so it is accessed
+  // without the mutex unless it has to be sent
+  if (m_buffers[m_current].size == m_chunk_size) {
+    std::unique_lock<std::mutex> lock {m_mutex};
+    submitCurrent(lock);
+  }
+  return m_chunk_size - m_buffers[m_current].size;
+}
+
+void SPIStreamWriter::submitCurrent(std::unique_lock<std::mutex>& lock) {
+  checkError();
+  m_buffers[m_current].busy = true;
+  m_queue.push_back(m_current);
+  m_condition.notify_all();
+  m_current = (m_current + 1) % BUFFERS;
+  // The thread of the writer takes the controller lock for the transfer, so
+  // this never returns if the caller holds an SPITransaction
+  m_condition.wait(lock, [this]() { return !m_buffers[m_current].busy; });
+  m_buffers[m_current].size = 0;
+}
+
+void SPIStreamWriter::checkError() {
+  if (m_error) {
+    auto error = m_error;
+    m_error = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+void SPIStreamWriter::sendLoop() {
+  std::unique_lock<std::mutex> lock {m_mutex};
+  while (true) {
+    m_condition.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+    if (m_queue.empty()) {
+      return;
+    }
+    auto& buffer = m_buffers[m_queue.front()];
+    m_queue.pop_front();
+    
+    // The transfer is done without the mutex, so the next buffer is filled
+    // meanwhile
+    lock.unlock();
+    std::exception_ptr error;
+    try {
+      // The buffers are never bigger than the maximum transfer size, so this
+      // is always a single message
+      m_bus.transfer(buffer.data.get(), nullptr, buffer.size);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    lock.lock();
+    
+    // Keep the first error, until the caller gets it
+    if (error && !m_error) {
+      m_error = error;
+    }
+    buffer.size = 0;
+    buffer.busy = false;
+    m_condition.notify_all();
+  }
+}
+
+} // end of namespace PiHWCtrl
@@ -30,14 +30,21 @@ std::shared_ptr<GpioManager> GpioManager::getSingleton() {
   return singleton;
 }
 
+GpioManager::GpioManager() {
+  for (auto& flag : m_reserved_flags) {
+    flag.store(false);
+  }
+}
+
 auto GpioManager::reserveGpio(int gpio) -> std::unique_ptr<GpioReservation> {
   if (gpio < 2 || gpio > 28) {
     throw BadGpioNumber(gpio);
   }
-  if (m_reserved_flags[gpio]) {
+  // Setting the flag and checking its previous value is a single operation, so
+  // two threads cannot reserve the same GPIO
+  if (m_reserved_flags[gpio].exchange(true)) {
     throw GpioAlreadyReserved(gpio);
   }
-  m_reserved_flags[gpio] = true;
   return std::make_unique<GpioReservation>(m_reserved_flags[gpio]);
 }
 
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file utils/LatencyHistogram.cpp
+ * @author nikoapos
+ */
+
+#include <algorithm> // for std::min
+#include <PiHWCtrl/utils/LatencyHistogram.h>
+
+namespace PiHWCtrl {
+
+constexpr std::size_t LatencyHistogram::BINS;
+
+LatencyHistogram::LatencyHistogram() {
+  for (auto& bin : m_bins) {
+    bin = 0;
+  }
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds latency) {
+  std::int64_t ns = latency.count();
+  
+  // Find the bin, which is the number of bits of the latency in microseconds
+  std::uint64_t us = ns > 0 ? ns / 1000 : 0;
+  std::size_t bin = 0;
+  while (us > 0 && bin < BINS - 1) {
+    us >>= 1;
+    ++bin;
+  }
+  m_bins[bin].fetch_add(1, std::memory_order_relaxed);
+  m_count.fetch_add(1, std::memory_order_relaxed);
+  
+  std::int64_t max = m_max.load(std::memory_order_relaxed);
+  while (ns > max && !m_max.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+  }
+}
+
+auto LatencyHistogram::getSnapshot() const -> Snapshot {
+  Snapshot snapshot;
+  snapshot.count = m_count.load(std::memory_order_relaxed);
+  snapshot.max = std::chrono::nanoseconds{m_max.load(std::memory_order_relaxed)};
+  for (std::size_t i = 0; i < BINS; ++i) {
+    snapshot.bins[i] = m_bins[i].load(std::memory_order_relaxed);
+  }
+  return snapshot;
+}
+
+std::chrono::nanoseconds LatencyHistogram::binUpperLimit(std::size_t bin) {
+  if (bin >= BINS - 1) {
+    return std::chrono::nanoseconds::max();
+  }
+  return std::chrono::microseconds{std::int64_t{1} << bin};
+}
+
+std::chrono::nanoseconds LatencyHistogram::Snapshot::percentile(double fraction) const {
+  // The bins are read one by one, so their sum might differ from the count
+  std::uint64_t total = 0;
+  for (auto bin : bins) {
+    total += bin;
+  }
+  if (total == 0) {
+    return std::chrono::nanoseconds{0};
+  }
+  std::uint64_t target = fraction * total;
+  std::uint64_t sum = 0;
+  for (std::size_t i = 0; i < BINS; ++i) {
+    sum += bins[i];
+    if (sum > target || sum == total) {
+      // The real latencies cannot be bigger than the maximum one
+      return std::min(binUpperLimit(i), max);
+    }
+  }
+  return max;
+}
+
+std::chrono::nanoseconds LatencyHistogram::percentile(double fraction) const {
+  return getSnapshot().percentile(fraction);
+}
+
+void LatencyHistogram::reset() {
+  for (auto& bin : m_bins) {
+    bin.store(0, std::memory_order_relaxed);
+  }
+  m_count.store(0, std::memory_order_relaxed);
+  m_max.store(0, std::memory_order_relaxed);
+}
+
+} // end of namespace PiHWCtrl
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file utils/PeriodStatistics.cpp
+ * @author nikoapos
+ */
+
+#include <algorithm> // for std::min, std::max, std::nth_element
+#include <PiHWCtrl/utils/PeriodStatistics.h>
+
+namespace PiHWCtrl {
+
+PeriodStatistics::PeriodStatistics(std::chrono::nanoseconds period, std::size_t history)
+        : m_period(period), m_history(history) {
+  m_recent.reserve(history);
+}
+
+void PeriodStatistics::recordExecution(Clock::time_point time) {
+  std::lock_guard<std::mutex> lock {m_mutex};
+  if (m_executions == 0) {
+    m_first = time;
+  } else {
+    auto jitter = std::chrono::duration_cast<std::chrono::nanoseconds>(time - m_last) - m_period;
+    if (m_executions == 1) {
+      m_min_jitter = jitter;
+      m_max_jitter = jitter;
+    } else {
+      m_min_jitter = std::min(m_min_jitter, jitter);
+      m_max_jitter = std::max(m_max_jitter, jitter);
+    }
+    auto abs_jitter = (jitter.count() < 0) ? -jitter : jitter;
+    if (m_recent.size() < m_history) {
+      m_recent.push_back(abs_jitter);
+    } else if (!m_recent.empty()) {
+      m_recent[m_recent_next] = abs_jitter;
+      m_recent_next = (m_recent_next + 1) % m_recent.size();
+    }
+  }
+  m_last = time;
+  ++m_executions;
+}
+
+void PeriodStatistics::recordOverrun(std::size_t missed) {
+  std::lock_guard<std::mutex> lock {m_mutex};
+  m_overruns += missed;
+}
+
+auto PeriodStatistics::getSnapshot() const -> Snapshot {
+  std::unique_lock<std::mutex> lock {m_mutex};
+  Snapshot snapshot {m_executions, m_overruns, 0., m_min_jitter, m_max_jitter,
+                     std::chrono::nanoseconds{0}};
+  if (m_executions > 1) {
+    std::chrono::duration<double> elapsed = m_last - m_first;
+    snapshot.rate = (m_executions - 1) / elapsed.count();
+  }
+  auto recent = m_recent;
+  lock.unlock();
+  
+  if (!recent.empty()) {
+    auto p99 = recent.begin() + (recent.size() * 99) / 100;
+    std::nth_element(recent.begin(), p99, recent.end());
+    snapshot.p99_jitter = *p99;
+  }
+  return snapshot;
+}
+
+void PeriodStatistics::reset() {
+  std::lock_guard<std::mutex> lock {m_mutex};
+  m_executions = 0;
+  m_overruns = 0;
+  m_min_jitter = std::chrono::nanoseconds{0};
+  m_max_jitter = std::chrono::nanoseconds{0};
+  m_recent.clear();
+  m_recent_next = 0;
+}
+
+} // end of namespace PiHWCtrl
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file utils/SamplingScheduler.cpp
+ * @author nikoapos
+ */
+
+#include <algorithm> // for std::find
+#include <PiHWCtrl/HWInterfaces/exceptions.h>
+#include <PiHWCtrl/utils/SamplingScheduler.h>
+
+namespace PiHWCtrl {
+
+namespace {
+
+// The job executed by the current worker thread, so we can detect when a job
+// cancels itself
+thread_local const void* current_job = nullptr;
+
+} // end of anonymous namespace
+
+std::shared_ptr<SamplingScheduler> SamplingScheduler::getSingleton() {
+  static std::shared_ptr<SamplingScheduler> singleton = std::make_shared<SamplingScheduler>();
+  return singleton;
+}
+
+SamplingScheduler::SamplingScheduler(unsigned int workers) {
+  if (workers == 0) {
+    throw Exception() << "SamplingScheduler needs at least one worker";
+  }
+  m_timer_thread = std::thread {[this]() { timerLoop(); }};
+  for (unsigned int i = 0; i < workers; ++i) {
+    m_worker_threads.emplace_back([this]() { workerLoop(); });
+  }
+}
+
+SamplingScheduler::~SamplingScheduler() {
+  {
+    std::lock_guard<std::mutex> lock {m_mutex};
+    m_stopping = true;
+  }
+  m_timer_condition.notify_all();
+  m_worker_condition.notify_all();
+  m_timer_thread.join();
+  for (auto& worker : m_worker_threads) {
+    worker.join();
+  }
+}
+
+auto SamplingScheduler::schedule(Job job, std::chrono::nanoseconds period) -> JobId {
+  if (period.count() <= 0) {
+    throw Exception() << "SamplingScheduler: the period must be positive";
+  }
+  std::lock_guard<std::mutex> lock {m_mutex};
+  JobId id = m_next_id++;
+  auto statistics = std::make_shared<PeriodStatistics>(period);
+  m_jobs.emplace(id, std::make_shared<JobState>(JobState{job, period, false, statistics}));
+  m_deadlines.push(Deadline{Clock::now(), id});
+  m_timer_condition.notify_one();
+  return id;
+}
+
+void SamplingScheduler::cancel(JobId id) {
+  std::unique_lock<std::mutex> lock {m_mutex};
+  auto it = m_jobs.find(id);
+  if (it == m_jobs.end()) {
+    return;
+  }
+  auto state = it->second;
+  // The deadline of the job stays in the heap and it is ignored when reached
+  m_jobs.erase(it);
+  // If the job is waiting for a worker we remove it, so it will not run
+  auto ready_it = std::find(m_ready.begin(), m_ready.end(), state);
+  if (ready_it != m_ready.end()) {
+    m_ready.erase(ready_it);
+    state->running = false;
+  }
+  if (current_job != state.get()) {
+    m_done_condition.wait(lock, [&state]() { return !state->running; });
+  }
+}
+
+auto SamplingScheduler::getStatistics(JobId id) -> std::shared_ptr<PeriodStatistics> {
+  std::lock_guard<std::mutex> lock {m_mutex};
+  auto it = m_jobs.find(id);
+  return (it == m_jobs.end()) ? nullptr : it->second->statistics;
+}
+
+void SamplingScheduler::timerLoop() {
+  std::unique_lock<std::mutex> lock {m_mutex};
+  while (!m_stopping) {
+    if (m_deadlines.empty()) {
+      m_timer_condition.wait(lock);
+      continue;
+    }
+    auto deadline = m_deadlines.top();
+    if (Clock::now() < deadline.time) {
+      // A new job with an earlier deadline will notify the condition
+      m_timer_condition.wait_until(lock, deadline.time);
+      continue;
+    }
+    m_deadlines.pop();
+    
+    auto it = m_jobs.find(deadline.id);
+    if (it == m_jobs.end()) {
+      // The job has been cancelled
+      continue;
+    }
+    auto& state = it->second;
+    
+    // If the previous execution is still running we skip this one
+    if (!state->running) {
+      state->running = true;
+      m_ready.push_back(state);
+      m_worker_condition.notify_one();
+    } else {
+      state->statistics->recordOverrun();
+    }
+    
+    // The next deadline is on the grid of the first one. If we are already
+    // late for it (the system was busy) we skip the missed deadlines.
+    auto next = deadline.time + state->period;
+    auto now = Clock::now();
+    if (next <= now) {
+      auto missed = (now - next) / state->period + 1;
+      next += missed * state->period;
+      state->statistics->recordOverrun(missed);
+    }
+    m_deadlines.push(Deadline{next, deadline.id});
+  }
+}
+
+void SamplingScheduler::workerLoop() {
+  std::unique_lock<std::mutex> lock {m_mutex};
+  while (true) {
+    m_worker_condition.wait(lock, [this]() { return m_stopping || !m_ready.empty(); });
+    if (m_stopping) {
+      return;
+    }
+    auto state = m_ready.front();
+    m_ready.pop_front();
+    
+    lock.unlock();
+    current_job = state.get();
+    state->statistics->recordExecution(Clock::now());
+    state->job();
+    current_job = nullptr;
+    lock.lock();
+    
+    state->running = false;
+    m_done_condition.notify_all();
+  }
+}
+
+} // end of namespace PiHWCtrl
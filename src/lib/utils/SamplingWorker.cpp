@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2017 nikoapos
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* 
+ * @file utils/SamplingWorker.cpp
+ * @author nikoapos
+ */
+
+#include <PiHWCtrl/HWInterfaces/exceptions.h>
+#include <PiHWCtrl/utils/SamplingWorker.h>
+
+namespace PiHWCtrl {
+
+SamplingWorker::~SamplingWorker() {
+  stop();
+}
+
+void SamplingWorker::start(Task task, std::chrono::nanoseconds period, WakeupFunction wakeup,
+                           OverrunPolicy policy) {
+  std::lock_guard<std::mutex> control_lock {m_control_mutex};
+  if (m_thread.joinable()) {
+    throw Exception() << "SamplingWorker already started";
+  }
+  m_stop_requested = false;
+  m_wakeup = wakeup;
+  auto statistics = std::make_shared<PeriodStatistics>(period);
+  m_statistics = statistics;
+  m_thread = std::thread {[this, task, period, policy, statistics]() {
+    using Clock = PeriodStatistics::Clock;
+    auto next = Clock::now();
+    while (!stopRequested()) {
+      statistics->recordExecution(Clock::now());
+      task();
+      
+      // The next deadline is on the grid of the first one, so the time spent
+      // by the task does not add to the period
+      next += period;
+      auto now = Clock::now();
+      if (period.count() == 0) {
+        next = now;
+      } else if (next < now) {
+        if (policy == OverrunPolicy::SKIP) {
+          auto missed = (now - next) / period + 1;
+          next += missed * period;
+          statistics->recordOverrun(missed);
+        } else {
+          statistics->recordOverrun();
+        }
+      }
+      if (!sleepUntil(next)) {
+        break;
+      }
+    }
+  }};
+}
+
+void SamplingWorker::stop() {
+  std::lock_guard<std::mutex> control_lock {m_control_mutex};
+  if (!m_thread.joinable()) {
+    return;
+  }
+  if (m_thread.get_id() == std::this_thread::get_id()) {
+    throw Exception() << "SamplingWorker cannot be stopped from its own task";
+  }
+  {
+    // The flag is set while holding the mutex, so a thread which is just
+    // going to wait on the condition variable will not miss the notification
+    std::lock_guard<std::mutex> lock {m_mutex};
+    m_stop_requested = true;
+  }
+  m_condition.notify_all();
+  if (m_wakeup) {
+    m_wakeup();
+  }
+  m_thread.join();
+}
+
+bool SamplingWorker::isRunning() const {
+  std::lock_guard<std::mutex> control_lock {m_control_mutex};
+  return m_thread.joinable();
+}
+
+std::shared_ptr<PeriodStatistics> SamplingWorker::getStatistics() const {
+  std::lock_guard<std::mutex> control_lock {m_control_mutex};
+  return m_statistics;
+}
+
+bool SamplingWorker::stopRequested() const {
+  return m_stop_requested;
+}
+
+bool SamplingWorker::sleepFor(std::chrono::nanoseconds duration) {
+  std::unique_lock<std::mutex> lock {m_mutex};
+  return !m_condition.wait_for(lock, duration, [this]() { return m_stop_requested.load(); });
+}
+
+bool SamplingWorker::sleepUntil(PeriodStatistics::Clock::time_point time) {
+  std::unique_lock<std::mutex> lock {m_mutex};
+  return !m_condition.wait_until(lock, time, [this]() { return m_stop_requested.load(); });
+}
+
+} // end of namespace PiHWCtrl
@@ -24,6 +24,18 @@
 %feature("director") PiHWCtrl::PWM;
 %include PiHWCtrl/HWInterfaces/PWM.h
 
+%{
+#include <PiHWCtrl/HWInterfaces/ParallelOutput.h>
+%}
+%feature("director") PiHWCtrl::ParallelOutput;
+%include PiHWCtrl/HWInterfaces/ParallelOutput.h
+
+%{
+#include <PiHWCtrl/HWInterfaces/ParallelInput.h>
+%}
+%feature("director") PiHWCtrl::ParallelInput;
+%include PiHWCtrl/HWInterfaces/ParallelInput.h
+
 %{
 #include <PiHWCtrl/HWInterfaces/AnalogInput.h>
 %}
@@ -63,6 +75,10 @@
 %feature("nodirector") PiHWCtrl::Observable<std::uint16_t>::notifyObservers;
 %feature("nodirector") PiHWCtrl::Observable<std::uint32_t>::notifyObservers;
 %feature("nodirector") PiHWCtrl::Observable<float>::notifyObservers;
+// The RAII subscriptions are for the C++ side only. Python code can use the
+// removeObserver() instead.
+%ignore PiHWCtrl::Observable::subscribe;
+%ignore PiHWCtrl::Observable::Subscription;
 %include PiHWCtrl/HWInterfaces/Observable.h
 %template(ObservableBool) PiHWCtrl::Observable<bool>;
 %template(ObservableUInt16) PiHWCtrl::Observable<std::uint16_t>;
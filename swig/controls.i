@@ -7,4 +7,12 @@
 #include <PiHWCtrl/controls/StateChangeFilter.h>
 %}
 %include PiHWCtrl/controls/StateChangeFilter.h
-%template(StateChangeFilterBool) PiHWCtrl::StateChangeFilter<bool>;
\ No newline at end of file
+%template(StateChangeFilterBool) PiHWCtrl::StateChangeFilter<bool>;
+%shared_ptr(PiHWCtrl::AsyncObserver<bool>)
+%shared_ptr(PiHWCtrl::AsyncObserver<float>)
+%{
+#include <PiHWCtrl/controls/AsyncObserver.h>
+%}
+%include PiHWCtrl/controls/AsyncObserver.h
+%template(AsyncObserverBool) PiHWCtrl::AsyncObserver<bool>;
+%template(AsyncObserverFloat) PiHWCtrl::AsyncObserver<float>;
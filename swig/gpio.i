@@ -1,6 +1,14 @@
 %module(package="PiHWCtrl", directors="1") gpio
 
 %include HWInterfaces.i
+
+// The Gpio class is needed for its Mode and Edge enumerations
+%{ 
+#include <PiHWCtrl/gpio/Gpio.h>
+%}
+%ignore PiHWCtrl::Gpio::Gpio(Gpio&&);
+%ignore PiHWCtrl::Gpio::operator=;
+%include PiHWCtrl/gpio/Gpio.h
     
 %{ 
 #include <PiHWCtrl/gpio/GpioSwitch.h>
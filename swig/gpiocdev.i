@@ -0,0 +1,28 @@
+%module(package="PiHWCtrl", directors="1") gpiocdev
+
+%include HWInterfaces.i
+%include <std_vector.i>
+
+%template(IntVector) std::vector<int>;
+
+// The GpioLineRequest class is needed for its Direction and Edge enumerations
+%{ 
+#include <PiHWCtrl/gpiocdev/GpioLineRequest.h>
+%}
+%include PiHWCtrl/gpiocdev/GpioLineRequest.h
+    
+%{ 
+#include <PiHWCtrl/gpiocdev/GpiocdevSwitch.h>
+%}
+%include PiHWCtrl/gpiocdev/GpiocdevSwitch.h
+    
+%{ 
+#include <PiHWCtrl/gpiocdev/GpiocdevBinaryInput.h>
+%}
+%ignore PiHWCtrl::GpiocdevBinaryInput::addEdgeEventObserver;
+%include PiHWCtrl/gpiocdev/GpiocdevBinaryInput.h
+    
+%{ 
+#include <PiHWCtrl/gpiocdev/GpiocdevGpioBank.h>
+%}
+%include PiHWCtrl/gpiocdev/GpiocdevGpioBank.h
@@ -3,4 +3,5 @@
 %include modules/BMP180.i
 %include modules/ADS1115.i
 %include modules/HCSR04.i
-%include modules/PCA9685.i
\ No newline at end of file
+%include modules/PCA9685.i
+%include modules/I2CBus.i
\ No newline at end of file
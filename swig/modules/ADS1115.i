@@ -9,18 +9,22 @@
 // Ignore the methods that use unique_ptr
 %ignore PiHWCtrl::ADS1115::factory;
 %ignore PiHWCtrl::ADS1115::conversionAnalogInput(Input);
+// Ignore the methods that use std::future
+%ignore PiHWCtrl::ADS1115::submitConversion;
 
 %include PiHWCtrl/modules/ADS1115.h
         
 // Create alternatives for the methods that use unique_ptr
 %{
 PiHWCtrl::ADS1115* ADS1115_factory(PiHWCtrl::ADS1115::AddressPin addr=PiHWCtrl::ADS1115::AddressPin::GND,
-                                   PiHWCtrl::ADS1115::DataRate data_rate=PiHWCtrl::ADS1115::DataRate::DR_128_SPS) {
-    return PiHWCtrl::ADS1115::factory(addr, data_rate).release();
+                                   PiHWCtrl::ADS1115::DataRate data_rate=PiHWCtrl::ADS1115::DataRate::DR_128_SPS,
+                                   int i2c_adapter=1) {
+    return PiHWCtrl::ADS1115::factory(addr, data_rate, i2c_adapter).release();
 }
 %}
 PiHWCtrl::ADS1115* ADS1115_factory(PiHWCtrl::ADS1115::AddressPin addr=PiHWCtrl::ADS1115::AddressPin::GND,
-                                   PiHWCtrl::ADS1115::DataRate data_rate=PiHWCtrl::ADS1115::DataRate::DR_128_SPS);
+                                   PiHWCtrl::ADS1115::DataRate data_rate=PiHWCtrl::ADS1115::DataRate::DR_128_SPS,
+                                   int i2c_adapter=1);
 
 %extend PiHWCtrl::ADS1115 { 
     AnalogInput<float>* conversionAnalogInput(PiHWCtrl::ADS1115::Input input, int dummy=0) {
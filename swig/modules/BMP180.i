@@ -2,6 +2,7 @@
 
 %include HWInterfaces.i
 %include <stdint.i>
+%include <std_string.i>
     
 %{ 
 #include <PiHWCtrl/modules/BMP180.h>
@@ -19,12 +20,16 @@
 // Create alternatives for the methods that use unique_ptr
 %{
 PiHWCtrl::BMP180* BMP180_factory(PiHWCtrl::BMP180::PressureMode mode=PiHWCtrl::BMP180::PressureMode::STANDARD,
-                                 float sea_level_pressure=1020) {
-    return PiHWCtrl::BMP180::factory(mode, sea_level_pressure).release();
+                                 float sea_level_pressure=1020,
+                                 const std::string& calibration_cache_dir="",
+                                 int i2c_adapter=1) {
+    return PiHWCtrl::BMP180::factory(mode, sea_level_pressure, calibration_cache_dir, i2c_adapter).release();
 }
 %}
 PiHWCtrl::BMP180* BMP180_factory(PiHWCtrl::BMP180::PressureMode mode=PiHWCtrl::BMP180::PressureMode::STANDARD,
-                                 float sea_level_pressure=1020);
+                                 float sea_level_pressure=1020,
+                                 const std::string& calibration_cache_dir="",
+                                 int i2c_adapter=1);
 
 %extend PiHWCtrl::BMP180 { 
     AnalogInput<std::uint16_t>* rawTemperatureAnalogInput(int dummy=0) {
@@ -0,0 +1,81 @@
+%module(package="PiHWCtrl", directors="1") modules
+
+%include <stdint.i>
+%include <std_vector.i>
+
+%template(IntVector) std::vector<int>;
+
+// The I2CBus is not wrapped directly. Its instrumentation is exposed with the
+// following free functions, which use the bus of the given adapter.
+%{
+#include <PiHWCtrl/i2c/I2CBus.h>
+
+struct I2CDeviceStatistics {
+  std::uint64_t transactions;
+  std::uint64_t bytes_read;
+  std::uint64_t bytes_written;
+  std::uint64_t read_errors;
+  std::uint64_t write_errors;
+  double transfer_p50_us;
+  double transfer_p99_us;
+  double transfer_max_us;
+  double wait_p50_us;
+  double wait_p99_us;
+  double wait_max_us;
+};
+
+namespace {
+double toMicroseconds(std::chrono::nanoseconds duration) {
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+}
+
+void I2C_setInstrumentationEnabled(bool enabled, int i2c_adapter=1) {
+  PiHWCtrl::I2CBus::open(i2c_adapter)->setInstrumentationEnabled(enabled);
+}
+
+std::vector<int> I2C_getInstrumentedDevices(int i2c_adapter=1) {
+  auto addresses = PiHWCtrl::I2CBus::open(i2c_adapter)->getInstrumentedDevices();
+  return std::vector<int>(addresses.begin(), addresses.end());
+}
+
+I2CDeviceStatistics I2C_getDeviceStatistics(std::uint8_t address, int i2c_adapter=1) {
+  auto statistics = PiHWCtrl::I2CBus::open(i2c_adapter)->getDeviceStatistics(address);
+  I2CDeviceStatistics result;
+  result.transactions = statistics.transactions;
+  result.bytes_read = statistics.bytes_read;
+  result.bytes_written = statistics.bytes_written;
+  result.read_errors = statistics.read_errors;
+  result.write_errors = statistics.write_errors;
+  result.transfer_p50_us = toMicroseconds(statistics.transfer_latency.percentile(0.5));
+  result.transfer_p99_us = toMicroseconds(statistics.transfer_latency.percentile(0.99));
+  result.transfer_max_us = toMicroseconds(statistics.transfer_latency.max);
+  result.wait_p50_us = toMicroseconds(statistics.wait_time.percentile(0.5));
+  result.wait_p99_us = toMicroseconds(statistics.wait_time.percentile(0.99));
+  result.wait_max_us = toMicroseconds(statistics.wait_time.max);
+  return result;
+}
+
+void I2C_resetStatistics(int i2c_adapter=1) {
+  PiHWCtrl::I2CBus::open(i2c_adapter)->resetStatistics();
+}
+%}
+
+struct I2CDeviceStatistics {
+  std::uint64_t transactions;
+  std::uint64_t bytes_read;
+  std::uint64_t bytes_written;
+  std::uint64_t read_errors;
+  std::uint64_t write_errors;
+  double transfer_p50_us;
+  double transfer_p99_us;
+  double transfer_max_us;
+  double wait_p50_us;
+  double wait_p99_us;
+  double wait_max_us;
+};
+
+void I2C_setInstrumentationEnabled(bool enabled, int i2c_adapter=1);
+std::vector<int> I2C_getInstrumentedDevices(int i2c_adapter=1);
+I2CDeviceStatistics I2C_getDeviceStatistics(std::uint8_t address, int i2c_adapter=1);
+void I2C_resetStatistics(int i2c_adapter=1);
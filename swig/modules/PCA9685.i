@@ -14,11 +14,11 @@
         
 // Create alternatives for the methods that use unique_ptr
 %{
-PiHWCtrl::PCA9685* PCA9685_factory(std::uint8_t address, int pwm_frequency=200) {
-    return PiHWCtrl::PCA9685::factory(address, pwm_frequency).release();
+PiHWCtrl::PCA9685* PCA9685_factory(std::uint8_t address, int pwm_frequency=200, int i2c_adapter=1) {
+    return PiHWCtrl::PCA9685::factory(address, pwm_frequency, i2c_adapter).release();
 }
 %}
-PiHWCtrl::PCA9685* PCA9685_factory(std::uint8_t address, int pwm_frequency=200);
+PiHWCtrl::PCA9685* PCA9685_factory(std::uint8_t address, int pwm_frequency=200, int i2c_adapter=1);
 
 %extend PiHWCtrl::PCA9685 { 
     PWM* getAsPWM(long led) {